@@ -20,11 +20,16 @@ __asm int my_sqrt(unsigned int x)
 	CMP r0, #1   ; make sure we handle the edge case so sqrt(1)=1
 	BLS exit		 ; just return the input if it is 0 or 1
 	
-	MOVS r1, #0  ; low search bound starts at 0
 	MOVS r2, r0  ; use input as high search bound
+	MOVS r1, #1
+	LSLS r1, r1, #16  ; ...but no more than 2^16, so guess^2 fits in 32 bits
+	CMP r2, r1
+	BLS bounded
+	MOVS r2, r1
+bounded
+	MOVS r1, #0  ; low search bound starts at 0
 	
-	PUSH {r3, r4}
-	// store r4-r5 on stack?
+	PUSH {r4, r5}  ; callee-saved, r3 is scratch
 	MOVS r3, #0  ; init guess
 	MOVS r4, r0  ; make last_guess != new_guess
 	
@@ -55,7 +60,7 @@ toohigh
 
 endloop
   MOVS r0, r3  ; return guess
-	POP {r3, r4}
+	POP {r4, r5}
 
 exit
 	BX lr
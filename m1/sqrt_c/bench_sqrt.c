@@ -0,0 +1,102 @@
+// Benchmark of integer square root strategies by input magnitude.
+//
+// Inputs are bucketed by bit length: the 8-bit bucket holds values in
+// [1, 2^8), the 16-bit bucket [2^8, 2^16) and so on.  Each function is timed
+// over repeated blocks of calls and the per-block ns/call is reported as
+// mean, median (p50) and 99th percentile, so one-off stalls from the OS show
+// up in p99 rather than skewing the median.
+//
+// Output is CSV on stdout.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sqrt_trunc.c"
+#include "sqrt_alt.c"
+
+int DEBUG=0;
+
+#define BLOCK_SIZE 4096  // calls per timed block
+#define BLOCKS 256       // timed blocks per function and bucket
+
+struct bench_func {
+  const char *name;
+  uint32_t (*func)(uint32_t);
+};
+
+struct bench_func bench_funcs[] = {
+  { "bisect", &sqrt_bisect },
+  { "newton", &sqrt_newton },
+  { "clz_table", &sqrt_clz_table },
+  { "digit", &sqrt_trunc },
+  { "libm", &sqrt_libm },
+  { NULL, NULL } // terminator
+};
+
+int bench_bits[] = { 8, 16, 24, 32, 0 };
+
+volatile uint32_t sink;
+
+// fixed seed so every run sees the same inputs
+static uint32_t xorshift_state = 2463534242U;
+static uint32_t xorshift32(void) {
+  xorshift_state ^= xorshift_state << 13;
+  xorshift_state ^= xorshift_state >> 17;
+  xorshift_state ^= xorshift_state << 5;
+  return xorshift_state;
+}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+void bench(struct bench_func *bf, int bits, uint32_t *inputs) {
+  double ns[BLOCKS];
+  double t_start, mean = 0;
+  uint32_t total = 0;
+
+  // warm up caches and branch predictors
+  for( int i=0; i<BLOCK_SIZE; i++ ) { total += bf->func(inputs[i]); }
+
+  for( int b=0; b<BLOCKS; b++ ) {
+    t_start = now_ns();
+    for( int i=0; i<BLOCK_SIZE; i++ ) {
+      total += bf->func(inputs[i]);
+    }
+    ns[b] = (now_ns() - t_start) / BLOCK_SIZE;
+    mean += ns[b];
+  }
+  sink = total;
+  mean /= BLOCKS;
+
+  qsort(ns, BLOCKS, sizeof(ns[0]), cmp_double);
+  printf("%s,%d,%.2f,%.2f,%.2f\n", bf->name, bits, mean,
+         ns[BLOCKS/2], ns[(BLOCKS*99)/100]);
+}
+
+int main(void) {
+  static uint32_t inputs[BLOCK_SIZE];
+
+  sqrt_clz_table_init();
+
+  printf("func,bits,mean_ns,p50_ns,p99_ns\n");
+  for( int *bits = bench_bits; *bits; bits++ ) {
+    uint32_t low = 1U << (*bits - 8);
+    uint32_t span = (uint32_t) ((1ULL << *bits) - low);
+    for( int i=0; i<BLOCK_SIZE; i++ ) {
+      inputs[i] = low + xorshift32() % span;
+    }
+    for( struct bench_func *bf = bench_funcs; bf->name; bf++ ) {
+      bench(bf, *bits, inputs);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <stdint.h>
+
+extern int DEBUG;
+
+// Truncated integer square root of a 64-bit input, digit-by-digit method.
+//
+// Exactly 32 passes.  The remainder is at most 2*root, 33 bits, so it is
+// kept in 64 bits along with the trial value.
+uint32_t sqrt64_trunc(uint64_t num) {
+  uint64_t rem = 0;
+  uint64_t root = 0;
+  uint64_t trial;
+
+  for( int i=0; i<32; i++ ) {
+    rem = (rem << 2) | (num >> 62);
+    num <<= 2;
+    root <<= 1;
+    trial = (root << 1) | 1;
+    if( rem >= trial ) {
+      rem -= trial;
+      root |= 1;
+    }
+    DEBUG && printf(" pass %2d: root=%11llu, rem=%11llu\n", i,
+                    (unsigned long long) root, (unsigned long long) rem);
+  }
+  return (uint32_t) root;
+}
@@ -0,0 +1,93 @@
+// Alternative truncated integer square root strategies, kept for comparison
+// against sqrt_trunc in the test harness and benchmarks.
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+extern int DEBUG;
+
+// Bisection search, the original sqrt_trunc.  Number of passes depends on
+// the input.
+uint32_t sqrt_bisect(uint32_t num) {
+  uint32_t low = 0;
+  uint32_t high = 1<<16;  // maximum sqrt of a 32-bit int, rounded up
+  uint32_t last_guess;
+  uint32_t guess = 0;
+  uint32_t squared;
+
+  // edge case, avoids sqrt_bisect(1) == 0
+  if(num<=1) { return num;};
+
+  // optimize upper limit
+  high = (num <= high) ? num : high;
+
+  do {
+    last_guess = guess;
+    guess = (low+high) >> 1;
+    squared = guess*guess;
+
+    if (squared != num) {
+      if (squared < num) {
+        low = guess;
+      } else {
+        high = guess;
+      }
+    }
+    DEBUG && printf(" sqrt(%d) =?%6u, sq=%11u, err=%+12ld, l= %u, h=%6u\n",
+                    num, guess, squared, (long)squared - num, low, high);
+  } while (last_guess != guess);
+  return guess;
+}
+
+// Newton-Raphson.  Starts from a power of two at or above the root, from
+// there the iterates decrease monotonically until they reach the root.
+uint32_t sqrt_newton(uint32_t num) {
+  uint32_t x, y;
+
+  if(num<=1) { return num; }
+
+  x = 1U << ((33 - __builtin_clz(num)) >> 1);
+  y = (x + num/x) >> 1;
+  while( y < x ) {
+    x = y;
+    y = (x + num/x) >> 1;
+    DEBUG && printf(" sqrt(%u) =?%6u\n", num, x);
+  }
+  return x;
+}
+
+// Newton-Raphson seeded from a table indexed by the top 8 bits of the input,
+// normalized with CLZ.  The seed is good to ~8 bits so one or two steps
+// finish the job.
+//
+// clz_seed[i] = ceil(16*sqrt(i+1)), an upper bound on sqrt(m)/256 for a
+// normalized input m whose top byte is i.
+static uint16_t clz_seed[256];
+
+void sqrt_clz_table_init(void) {
+  for( int i=0; i<256; i++ ) {
+    clz_seed[i] = (uint16_t) ceil(16.0 * sqrt(i+1.0));
+  }
+}
+
+uint32_t sqrt_clz_table(uint32_t num) {
+  uint32_t x, y;
+  int shift;
+
+  if(num<=1) { return num; }
+
+  shift = __builtin_clz(num) & ~1;  // normalize by an even amount
+  x = ((uint32_t) clz_seed[(num << shift) >> 24] << 8) >> (shift >> 1);
+  y = (x + num/x) >> 1;
+  while( y < x ) {
+    x = y;
+    y = (x + num/x) >> 1;
+    DEBUG && printf(" sqrt(%u) =?%6u\n", num, x);
+  }
+  return x;
+}
+
+// libm double precision, exact for all 32-bit inputs
+uint32_t sqrt_libm(uint32_t num) {
+  return (uint32_t) sqrt((double) num);
+}
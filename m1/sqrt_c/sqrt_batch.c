@@ -0,0 +1,121 @@
+// Batched truncated integer square root for host-side bulk processing.
+//
+// The SIMD kernels estimate the root in single precision and then apply an
+// exact integer correction, so the results are bit-identical to sqrt_trunc.
+// The float estimate is within +/-1 of the true root: converting the input
+// to float costs at most 2^-24 relative error, which sqrt halves, and the
+// root is below 2^16.
+//
+// sqrt_trunc_batch picks the best kernel the CPU supports on first use.
+#include <stdint.h>
+#include <stddef.h>
+
+uint32_t sqrt_trunc(uint32_t num);
+
+void sqrt_trunc_batch_scalar(const uint32_t *in, uint32_t *out, size_t n) {
+  for( size_t i=0; i<n; i++ ) {
+    out[i] = sqrt_trunc(in[i]);
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#define HAVE_SQRT_BATCH_SIMD 1
+
+// SSE2 has no unsigned compare or 32-bit multiply, so compares are done with
+// the sign bit flipped and r*r is built from 16-bit multiplies (r < 2^16).
+__attribute__((target("sse2")))
+void sqrt_trunc_batch_sse2(const uint32_t *in, uint32_t *out, size_t n) {
+  const __m128i lo16 = _mm_set1_epi32(0xffff);
+  const __m128i max_root = _mm_set1_epi32(0xffff);
+  const __m128i sign = _mm_set1_epi32(0x80000000);
+  const __m128 two16 = _mm_set1_ps(65536.0f);
+  size_t i = 0;
+
+  for( ; i+4 <= n; i+=4 ) {
+    __m128i x = _mm_loadu_si128((const __m128i *) (in+i));
+
+    // unsigned -> float, split in halves so each conversion is exact
+    __m128 xf = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 16)), two16),
+                           _mm_cvtepi32_ps(_mm_and_si128(x, lo16)));
+    __m128i r = _mm_cvttps_epi32(_mm_sqrt_ps(xf));
+
+    // clamp, sqrt(2^32-1) may round up to 65536
+    __m128i over = _mm_cmpgt_epi32(r, max_root);
+    r = _mm_or_si128(_mm_andnot_si128(over, r), _mm_and_si128(over, max_root));
+
+    // r*r > x  =>  r--
+    __m128i sq = _mm_or_si128(_mm_mullo_epi16(r, r), _mm_slli_epi32(_mm_mulhi_epu16(r, r), 16));
+    __m128i dec = _mm_cmpgt_epi32(_mm_xor_si128(sq, sign), _mm_xor_si128(x, sign));
+    r = _mm_add_epi32(r, dec);
+
+    // x - r*r >= 2r+1  =>  r++  (difference is small, signed compare is safe)
+    sq = _mm_or_si128(_mm_mullo_epi16(r, r), _mm_slli_epi32(_mm_mulhi_epu16(r, r), 16));
+    __m128i diff = _mm_sub_epi32(x, sq);
+    __m128i step = _mm_add_epi32(_mm_add_epi32(r, r), _mm_set1_epi32(1));
+    __m128i inc = _mm_xor_si128(_mm_cmpgt_epi32(step, diff), _mm_set1_epi32(-1));
+    r = _mm_sub_epi32(r, inc);
+
+    _mm_storeu_si128((__m128i *) (out+i), r);
+  }
+  sqrt_trunc_batch_scalar(in+i, out+i, n-i);
+}
+
+__attribute__((target("avx2")))
+void sqrt_trunc_batch_avx2(const uint32_t *in, uint32_t *out, size_t n) {
+  const __m256i lo16 = _mm256_set1_epi32(0xffff);
+  const __m256i max_root = _mm256_set1_epi32(0xffff);
+  const __m256 two16 = _mm256_set1_ps(65536.0f);
+  size_t i = 0;
+
+  for( ; i+8 <= n; i+=8 ) {
+    __m256i x = _mm256_loadu_si256((const __m256i *) (in+i));
+
+    __m256 xf = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(x, 16)), two16),
+                              _mm256_cvtepi32_ps(_mm256_and_si256(x, lo16)));
+    __m256i r = _mm256_cvttps_epi32(_mm256_sqrt_ps(xf));
+    r = _mm256_min_epi32(r, max_root);
+
+    // r*r > x  =>  r--   (a > b unsigned  <=>  max(a,b) != b)
+    __m256i sq = _mm256_mullo_epi32(r, r);
+    __m256i not_dec = _mm256_cmpeq_epi32(_mm256_max_epu32(sq, x), x);
+    r = _mm256_sub_epi32(r, _mm256_andnot_si256(not_dec, _mm256_set1_epi32(1)));
+
+    // x - r*r >= 2r+1  =>  r++
+    sq = _mm256_mullo_epi32(r, r);
+    __m256i diff = _mm256_sub_epi32(x, sq);
+    __m256i step = _mm256_add_epi32(_mm256_add_epi32(r, r), _mm256_set1_epi32(1));
+    __m256i no_inc = _mm256_cmpgt_epi32(step, diff);
+    r = _mm256_add_epi32(r, _mm256_andnot_si256(no_inc, _mm256_set1_epi32(1)));
+
+    _mm256_storeu_si256((__m256i *) (out+i), r);
+  }
+  sqrt_trunc_batch_scalar(in+i, out+i, n-i);
+}
+#endif
+
+static void (*batch_kernel)(const uint32_t *, uint32_t *, size_t);
+
+// name of the kernel selected by sqrt_trunc_batch
+const char *sqrt_trunc_batch_select(void) {
+#ifdef HAVE_SQRT_BATCH_SIMD
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports("avx2") ) {
+    batch_kernel = &sqrt_trunc_batch_avx2;
+    return "avx2";
+  }
+  if( __builtin_cpu_supports("sse2") ) {
+    batch_kernel = &sqrt_trunc_batch_sse2;
+    return "sse2";
+  }
+#endif
+  batch_kernel = &sqrt_trunc_batch_scalar;
+  return "scalar";
+}
+
+// out[i] = sqrt_trunc(in[i]) for i < n
+void sqrt_trunc_batch(const uint32_t *in, uint32_t *out, size_t n) {
+  if( !batch_kernel ) { sqrt_trunc_batch_select(); }
+  batch_kernel(in, out, n);
+}
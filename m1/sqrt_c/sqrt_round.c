@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include <stdint.h>
+
+extern int DEBUG;
+
+// Integer square root rounded to nearest, digit-by-digit method.
+//
+// Same 16 fixed passes as sqrt_trunc, then one compare on the remainder:
+// sqrt(num) >= root + 1/2  <=>  num >= root^2 + root + 1/4  <=>  rem > root
+// (num is an integer, so exact halves cannot occur).  Returns 65536 for
+// inputs above 65535.5^2.
+uint32_t sqrt_round(uint32_t num) {
+  uint32_t rem = 0;
+  uint32_t root = 0;
+  uint32_t trial;
+
+  for( int i=0; i<16; i++ ) {
+    rem = (rem << 2) | (num >> 30);
+    num <<= 2;
+    root <<= 1;
+    trial = (root << 1) | 1;
+    if( rem >= trial ) {
+      rem -= trial;
+      root |= 1;
+    }
+    DEBUG && printf(" pass %2d: root=%6u, rem=%7u\n", i, root, rem);
+  }
+  if( rem > root ) {
+    root++;
+  }
+  return root;
+}
@@ -3,35 +3,32 @@
 
 extern int DEBUG;
 
+// Truncated integer square root, digit-by-digit method, restoring form.
+//
+// Produces one result bit per pass, most significant first, by bringing down
+// the next two input bits into a running remainder.  Each pass compares the
+// remainder with the trial value and subtracts only when it fits, so the
+// remainder never goes negative and needs no correction.  Always runs exactly 16
+// passes using only shifts, adds and compares, so the worst case cycle count
+// equals the best case.
+//
+// Invariant: rem = (input bits consumed so far) - root^2, and 0 <= rem <= 2*root
+// so rem never needs more than 18 bits.
 uint32_t sqrt_trunc(uint32_t num) {
-  uint32_t low = 0;
-  uint32_t high = 1<<15+1;  // maximum sqrt of a 32-bit int
-  uint32_t last_guess;
-  uint32_t guess = 0;
-  uint32_t squared;
-
-  // edge case, avoids sqrt_trun(1) == 0
-  if(num<=1) { return num;};
-
-  // optimize upper limit
-  high = (num <= high) ? num : high;
-
-  do {
-    last_guess = guess;
-    guess = (low+high) >> 1;
-    squared = guess*guess;
-
-    if (squared != num) {
-      if (squared < num) {
-        low = guess;
-      } else {
-        high = guess;
-      }
+  uint32_t rem = 0;   // running remainder
+  uint32_t root = 0;  // partial root
+  uint32_t trial;     // 2*root+1, the amount rem grows by if the next bit is 1
+
+  for( int i=0; i<16; i++ ) {
+    rem = (rem << 2) | (num >> 30);  // bring down next two bits
+    num <<= 2;
+    root <<= 1;
+    trial = (root << 1) | 1;
+    if( rem >= trial ) {
+      rem -= trial;
+      root |= 1;
     }
-    DEBUG && printf(" sqrt(%d) =?%6u, sq=%11u, err=%+12ld, l= %u, h=%6u\n",
-                    num, guess, squared, (long)squared - num, low, high);
-  } while (last_guess != guess);
-  return guess;
+    DEBUG && printf(" pass %2d: root=%6u, rem=%7u\n", i, root, rem);
+  }
+  return root;
 }
-
-
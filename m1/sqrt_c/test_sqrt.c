@@ -2,6 +2,10 @@
 #include <stdint.h>
 
 #include "sqrt_trunc.c"
+#include "sqrt_batch.c"
+#include "sqrt_alt.c"
+#include "sqrt_round.c"
+#include "sqrt64_trunc.c"
 #include "tests.c"
 
 int DEBUG=0;
@@ -11,6 +15,20 @@ int main(void) {
 
   test_trunc(&sqrt_trunc);
   test_trunc_rand(&sqrt_trunc);
+  test_trunc(&sqrt_bisect);
+  test_trunc(&sqrt_newton);
+  sqrt_clz_table_init();
+  test_trunc(&sqrt_clz_table);
+  test_trunc_rand(&sqrt_clz_table);
+
+  test_best(&sqrt_round);
+  test_best_random(&sqrt_round);
+
+  test_trunc64(&sqrt64_trunc);
+  test_trunc64_rand(&sqrt64_trunc, 5003);
+
+  printf("Batch kernel: %s\n", sqrt_trunc_batch_select());
+  test_trunc_batch(&sqrt_trunc_batch, &sqrt_trunc);
 
   uint32_t total = 0;
   for(int i = 0; i<10000; i++){
@@ -116,6 +116,8 @@ int test_best( uint32_t (*func)(uint32_t) ) {
   uint32_t input, output, func_out;
   int failed = 0;
 
+  printf("TEST: best approximation\n");
+  printf("------------------------\n");
   for(int i = 0; ; i++ ){
     input = test_cases[i][0];
     output = test_cases[i][1];
@@ -134,7 +136,7 @@ int test_best( uint32_t (*func)(uint32_t) ) {
       printf("Passed: sqrt(%u) = %d\n", input, func_out);
     }
   }
-  printf("Test done\n");
+  printf("Test done\n\n");
   return failed;
 }
 
@@ -149,9 +151,10 @@ int test_best_random( uint32_t (*func)(uint32_t) ) {
   for(int i=0; i<count; i++ ){
     input = rand() + rand(); // RAND_MAX is 2^31
     func_out = func(input);
-    sq_err = abs(func_out*func_out - input);
-    pre_sq_err = abs((func_out-1)*(func_out-1) - input);
-    post_sq_err = abs((func_out+1)*(func_out+1) - input);
+    // 64-bit math, the squares overflow 32 bits near the top of the range
+    sq_err = llabs((int64_t) func_out*func_out - input);
+    pre_sq_err = llabs(((int64_t) func_out-1)*((int64_t) func_out-1) - input);
+    post_sq_err = llabs(((int64_t) func_out+1)*((int64_t) func_out+1) - input);
     if( sq_err > pre_sq_err ) {
       printf("FAILED: sqrt(%u) != %u, %u is better\n", input, func_out, func_out-1);
       DEBUG=1;
@@ -173,6 +176,109 @@ int test_best_random( uint32_t (*func)(uint32_t) ) {
   } else {
     printf("Passed %d random tests\n", count);
   }
+  printf("\n");
+  return failed;
+}
+
+
+// batch function must match the scalar function element for element
+int test_trunc_batch( void (*batch)(const uint32_t *, uint32_t *, size_t),
+                      uint32_t (*func)(uint32_t) ) {
+  int failed = 0;
+  int count = 1 << 16;
+  static uint32_t in[1 << 16], out[1 << 16];
+
+  printf("TEST: batch truncation approximation\n");
+  printf("------------------------------------\n");
+  // bottom, and top of the range, odd length to exercise the scalar tail
+  for( int pass = 0; pass < 2; pass++ ) {
+    for( int i=0; i<count; i++ ) {
+      in[i] = pass ? (uint32_t) -1 - i : (uint32_t) i;
+    }
+    batch(in, out, count-1);
+    for( int i=0; i<count-1; i++ ) {
+      if( out[i] != func(in[i]) ) {
+        printf("FAILED: sqrt(%u), got %u, but expected %u\n", in[i], out[i], func(in[i]));
+        failed++;
+      }
+    }
+  }
+  if(failed) {
+    printf("Failed %d/%d\n", failed, 2*(count-1));
+  } else {
+    printf("Passed %d batch tests\n", 2*(count-1));
+  }
+  printf("\n");
   return failed;
 }
 
+
+// 64-bit input, truncated output: checks root^2 <= n < (root+1)^2 directly
+static int check_trunc64( uint32_t (*func)(uint64_t), uint64_t input ) {
+  unsigned __int128 root = func(input);
+  return (root*root <= input) && ((root+1)*(root+1) > input);
+}
+
+int test_trunc64( uint32_t (*func)(uint64_t) ) {
+  uint64_t test_cases[] = {
+    0, 1, 2, 3, 4, 5, 8, 9, 10,
+    4294967295ULL, 4294967296ULL, 4294967297ULL,
+    18446744065119617024ULL,  // (2^32-1)^2 - 1
+    18446744065119617025ULL,  // (2^32-1)^2
+    18446744073709551614ULL,
+    18446744073709551615ULL,
+  };
+  int count = sizeof(test_cases)/sizeof(test_cases[0]);
+  int failed = 0;
+
+  printf("TEST: 64-bit truncation approximation\n");
+  printf("-------------------------------------\n");
+  for( int i=0; i<count; i++ ) {
+    if( !check_trunc64(func, test_cases[i]) ) {
+      printf("FAILED: sqrt(%llu), got %u\n", (unsigned long long) test_cases[i], func(test_cases[i]));
+      failed++;
+      DEBUG=1;
+      func(test_cases[i]);
+      DEBUG=0;
+    }
+  }
+  if(failed) {
+    printf("Failed %d/%d tests\n", failed, count);
+  } else {
+    printf("Passed all %d tests\n", count);
+  }
+  printf("\n");
+  return failed;
+}
+
+// fixed seed so any failure can be reproduced
+int test_trunc64_rand( uint32_t (*func)(uint64_t), uint64_t seed ) {
+  int failed = 0;
+  int count = 1000000;
+  uint64_t state = seed;
+  uint64_t input;
+
+  printf("TEST: 64-bit truncation approximation, random input (seed %llu)\n",
+         (unsigned long long) seed);
+  printf("--------------------------------------------------------------\n");
+  for( int i=0; i<count; i++ ) {
+    // splitmix64, shifted so every input bit length is covered
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    input = z >> (z & 63);
+
+    if( !check_trunc64(func, input) ) {
+      printf("FAILED: sqrt(%llu), got %u\n", (unsigned long long) input, func(input));
+      failed++;
+    }
+  }
+  if(failed) {
+    printf("Failed %d/%d\n", failed, count);
+  } else {
+    printf("Passed %d random tests\n", count);
+  }
+  printf("\n");
+  return failed;
+}
@@ -0,0 +1,207 @@
+// Exhaustive verifier: checks every 32-bit input against a reference.
+//
+// The input range is cut into fixed size chunks which are handed out in
+// increasing order to a pool of worker threads (one per core).  On a mismatch
+// workers stop picking up chunks above the failing input, so the reported
+// counterexample is always the smallest failing input regardless of thread
+// timing.
+//
+// usage: verify_sqrt [threads]
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "sqrt_trunc.c"
+#include "sqrt_batch.c"
+#include "sqrt_round.c"
+
+int DEBUG=0;
+
+#define CHUNK_BITS 20
+#define CHUNK_COUNT (1U << (32-CHUNK_BITS))
+#define NO_FAILURE UINT64_MAX
+
+// exact for all 32-bit inputs, doubles have plenty of mantissa to spare
+uint32_t ref_trunc(uint32_t num) {
+  return (uint32_t) sqrt((double) num);
+}
+
+// sqrt(n) is never within 2^-19 of a half integer, so rounding is exact too
+uint32_t ref_round(uint32_t num) {
+  return (uint32_t) (sqrt((double) num) + 0.5);
+}
+
+// batch kernels are checked a chunk at a time, func is used for reporting
+struct verify_case {
+  const char *name;
+  uint32_t (*func)(uint32_t);
+  uint32_t (*ref)(uint32_t);
+  void (*batch)(const uint32_t *, uint32_t *, size_t);
+  const char *cpu;  // required CPU feature, NULL if none
+};
+
+struct verify_case verify_cases[] = {
+  { "sqrt_trunc", &sqrt_trunc, &ref_trunc, NULL, NULL },
+  { "sqrt_round", &sqrt_round, &ref_round, NULL, NULL },
+#ifdef HAVE_SQRT_BATCH_SIMD
+  { "sqrt_trunc_batch_sse2", &sqrt_trunc, &ref_trunc, &sqrt_trunc_batch_sse2, "sse2" },
+  { "sqrt_trunc_batch_avx2", &sqrt_trunc, &ref_trunc, &sqrt_trunc_batch_avx2, "avx2" },
+#endif
+  { NULL, NULL, NULL, NULL, NULL } // terminator
+};
+
+static struct verify_case *cur_case;
+static atomic_uint next_chunk;
+static atomic_uint_fast64_t checked;
+static atomic_uint_fast64_t first_fail;
+
+static void record_failure(uint64_t input) {
+  uint64_t prev = atomic_load(&first_fail);
+  while( input < prev && !atomic_compare_exchange_weak(&first_fail, &prev, input) ) ;
+}
+
+static void *verify_worker(void *arg) {
+  (void) arg;
+  uint32_t (*func)(uint32_t) = cur_case->func;
+  uint32_t (*ref)(uint32_t) = cur_case->ref;
+  void (*batch)(const uint32_t *, uint32_t *, size_t) = cur_case->batch;
+  uint32_t *in = NULL, *out = NULL;
+
+  if( batch ) {
+    in = malloc(sizeof(uint32_t) << CHUNK_BITS);
+    out = malloc(sizeof(uint32_t) << CHUNK_BITS);
+  }
+
+  for( ;; ) {
+    uint32_t chunk = atomic_fetch_add(&next_chunk, 1);
+    if( chunk >= CHUNK_COUNT ) { break; }
+    uint64_t start = (uint64_t) chunk << CHUNK_BITS;
+    if( start > atomic_load(&first_fail) ) { break; }
+
+    uint64_t end = start + (1U << CHUNK_BITS);
+    uint64_t input;
+    if( batch ) {
+      for( input = start; input < end; input++ ) {
+        in[input-start] = (uint32_t) input;
+      }
+      batch(in, out, end-start);
+      for( input = start; input < end; input++ ) {
+        if( out[input-start] != ref((uint32_t) input) ) {
+          record_failure(input);
+          break;
+        }
+      }
+    } else {
+      for( input = start; input < end; input++ ) {
+        if( func((uint32_t) input) != ref((uint32_t) input) ) {
+          record_failure(input);
+          break;
+        }
+      }
+    }
+    atomic_fetch_add(&checked, input - start);
+  }
+  free(in);
+  free(out);
+  return NULL;
+}
+
+// __builtin_cpu_supports only accepts string literals
+static int cpu_supports(const char *feature) {
+#ifdef HAVE_SQRT_BATCH_SIMD
+  if( !strcmp(feature, "sse2") ) { return __builtin_cpu_supports("sse2"); }
+  if( !strcmp(feature, "avx2") ) { return __builtin_cpu_supports("avx2"); }
+#endif
+  (void) feature;
+  return 0;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int verify(struct verify_case *vc, int threads) {
+  pthread_t pool[threads];
+  double t_start, t_elapsed;
+  uint64_t done;
+
+  cur_case = vc;
+  atomic_store(&next_chunk, 0);
+  atomic_store(&checked, 0);
+  atomic_store(&first_fail, NO_FAILURE);
+
+  printf("VERIFY: %s, all 2^32 inputs, %d threads\n", vc->name, threads);
+  printf("-------------------------------------------------\n");
+  t_start = now();
+  for( int i=0; i<threads; i++ ) {
+    pthread_create(&pool[i], NULL, verify_worker, NULL);
+  }
+
+  // progress report until the workers have run out of chunks
+  while( atomic_load(&next_chunk) < CHUNK_COUNT + threads ) {
+    sleep(1);
+    done = atomic_load(&checked);
+    t_elapsed = now() - t_start;
+    printf("\r  %5.1f%%  %10.3e inputs/s", 100.0 * done / 4294967296.0, done / t_elapsed);
+    fflush(stdout);
+    if( atomic_load(&first_fail) != NO_FAILURE ) { break; }
+  }
+  for( int i=0; i<threads; i++ ) {
+    pthread_join(pool[i], NULL);
+  }
+  t_elapsed = now() - t_start;
+  done = atomic_load(&checked);
+  printf("\r  checked %llu inputs in %.1f s (%.3e inputs/s)\n",
+         (unsigned long long) done, t_elapsed, done / t_elapsed);
+
+  uint64_t fail = atomic_load(&first_fail);
+  if( fail != NO_FAILURE ) {
+    uint32_t input = (uint32_t) fail;
+    uint32_t got;
+    if( vc->batch ) {
+      // rerun the whole vector the input was in, not the scalar tail
+      uint32_t in[8], out[8];
+      for( int i=0; i<8; i++ ) { in[i] = (input & ~7U) + i; }
+      vc->batch(in, out, 8);
+      got = out[input & 7];
+    } else {
+      got = vc->func(input);
+    }
+    printf("FAILED: %s(%u) = %u, expected %u\n", vc->name, input, got, vc->ref(input));
+    DEBUG=1;
+    vc->func(input);
+    DEBUG=0;
+    printf("\n");
+    return 1;
+  }
+  printf("Passed all inputs\n\n");
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  int threads = sysconf(_SC_NPROCESSORS_ONLN);
+  int failed = 0;
+
+  if( argc > 1 ) { threads = atoi(argv[1]); }
+  if( threads < 1 ) { threads = 1; }
+
+#ifdef HAVE_SQRT_BATCH_SIMD
+  __builtin_cpu_init();
+#endif
+  for( struct verify_case *vc = verify_cases; vc->name; vc++ ) {
+    if( vc->cpu && !cpu_supports(vc->cpu) ) {
+      printf("SKIPPED: %s, CPU lacks %s\n\n", vc->name, vc->cpu);
+      continue;
+    }
+    failed += verify(vc, threads);
+  }
+  return failed ? 1 : 0;
+}
@@ -28,8 +28,11 @@
 
 // the CMSIS Peripheral Access Layer for our processor
 #include "MKL25Z4.h"
+#include "cmsis_nvic.h"  // NVIC_SetVector
 #include "adc.h"
 #include "timer.h"  // adc_flag
+#include "flow_calc.h"  // VORTEX_CIC
+#include "cic.h"
 
 unsigned int adc_vals[3];
 
@@ -40,6 +43,10 @@ int adc_init(void) {
   adc_config();
   cal_status = adc_calibrate();
   adc_config();  // restore any settings modified during calibration
+#ifdef VORTEX_CIC
+  cic_reset(&vortex_cic, CIC_DECIM);
+  adc_cic_start();
+#endif
   return cal_status;
 }
 
@@ -207,11 +214,100 @@ unsigned int adc_read(unsigned int channel) {
 
 }
 
-void read_all_adcs(void) {
+#ifdef VORTEX_CIC
+static volatile UCHAR cic_flag = 0;  // set by the isr with each decimated sample
+static unsigned short cic_hold = 0;  // last vortex conversion
+static unsigned int cic_outputs = 0; // since the last temperature conversion
+static UCHAR cic_temp = 0;           // 1 while the temperature is converting
+
+// one conversion done: feed the CIC, and every CIC_TEMP_EVERY outputs give
+// one trigger to the temperature channel.  The CIC gets the previous
+// vortex sample again for that slot so its input stays evenly spaced.
+//
+// Runs at CIC_DECIM * 10 kHz, 160 kHz, so it has 300 cycles at 48 MHz
+// before the next conversion.  Counted by hand with the M0+ timings
+// (exception entry and exit 15 each, loads and stores 2, the R[0] read
+// about 4 through the peripheral bridge, cic_sample an out of line call):
+// about 100 cycles for the 15 inputs that only integrate and 145 for the
+// one that also combs and sets cic_flag, 103 on average.  That is a third
+// of the CPU; R = 32 would take over two thirds, so check the budget
+// before raising CIC_DECIM.
+static void adc_cic_isr(void) {
+  unsigned short sample = ADC0->R[0];  // clears COCO
+  unsigned short out;
+
+  if( cic_temp ) {
+    adc_vals[2] = sample;
+    sample = cic_hold;
+    ADC0->SC1[0] = ADC_SC1_AIEN_MASK | ADC_SC1_ADCH(9);
+    cic_temp = 0;
+  } else {
+    cic_hold = sample;
+  }
+  if( cic_sample(&vortex_cic, sample, &out) ) {
+    if( cic_flag ) {
+      adc_overruns++;  // main has not taken the last output
+    }
+    adc_vals[1] = out;
+    cic_flag = 1;
+    if( ++cic_outputs == CIC_TEMP_EVERY ) {
+      cic_outputs = 0;
+      ADC0->SC1[0] = ADC_SC1_AIEN_MASK | ADC_SC1_ADCH(26);
+      cic_temp = 1;
+    }
+  }
+}
+
+// Oversampled vortex acquisition: TPM1 overflows every
+// 1 / (CIC_DECIM * 10 kHz), 6.25 us for R = 16, and triggers a conversion;
+// the interrupt runs the CIC so one decimated sample arrives per 100 us
+// tick.  TPM1 is the one TPM outputs.cpp leaves free, and the PIT is not
+// touched since the mbed us_ticker behind Ticker, wait and Timer owns it.
+// Hardware averaging is off, the CIC does the averaging.  The 16-bit
+// conversion with the long sample time of adc_config takes about 2 us at
+// 24 MHz, inside the trigger period up to R = 32.
+void adc_cic_start(void) {
+  // TPM1 counting the 48 MHz MCGPLLCLK/2, the same source PwmOut selects
+  SIM->SCGC6 |= SIM_SCGC6_TPM1_MASK;
+  SIM->SOPT2 = (SIM->SOPT2 & ~SIM_SOPT2_TPMSRC_MASK) | SIM_SOPT2_TPMSRC(1);
+  TPM1->SC = 0;  // stopped while it is set up
+  TPM1->CNT = 0;
+  TPM1->MOD = 48000000 / (CIC_DECIM * 10000) - 1;
+  TPM1->SC = TPM_SC_TOF_MASK | TPM_SC_CMOD(1);  // prescale 1, no interrupt
+
+  // alternate trigger 0x9 = TPM1 overflow
+  SIM->SOPT7 = SIM_SOPT7_ADC0ALTTRGEN_MASK | SIM_SOPT7_ADC0TRGSEL(0x9);
+
+  // one conversion per trigger
+  ADC0->SC3 &= ~(ADC_SC3_ADCO_MASK | ADC_SC3_AVGE_MASK);
+  ADC0->SC2 |= ADC_SC2_ADTRG_MASK;
+
+  NVIC_SetVector(ADC0_IRQn, (uint32_t) &adc_cic_isr);
+  NVIC_EnableIRQ(ADC0_IRQn);
+  ADC0->SC1[0] = ADC_SC1_AIEN_MASK | ADC_SC1_ADCH(9);
+}
+
+// returns 1 if the CIC produced a new vortex sample, adc_vals[1].  The
+// temperature in adc_vals[2] is refreshed every CIC_TEMP_EVERY samples,
+// VREFL in adc_vals[0] is not read in this mode.
+int read_all_adcs(void) {
+  if(cic_flag) {
+    cic_flag = 0;
+    adc_flag = 0;
+    return 1;
+  }
+  return 0;
+}
+#else
+// returns 1 if the 100us tick asked for new readings and they were taken
+int read_all_adcs(void) {
   if(adc_flag) {
     adc_vals[0] = adc_read(CHANNEL_0);
     adc_vals[1] = adc_read(CHANNEL_1);
     adc_vals[2] = adc_read(CHANNEL_2);
     adc_flag = 0;
+    return 1;
   }
+  return 0;
 }
+#endif
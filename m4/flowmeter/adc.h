@@ -15,7 +15,8 @@ int adc_init(void);
 void adc_config(void);
 int adc_calibrate(void);
 unsigned int adc_read(unsigned int channel);
-void read_all_adcs();
+int read_all_adcs();
+void adc_cic_start(void);
 
 extern unsigned int adc_vals[3];
 
@@ -0,0 +1,81 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  biquad.cpp
+
+  Band-pass front end for the vortex crossing detector:
+  a cascade of fixed point direct form I biquads, the
+  same arithmetic as CMSIS arm_biquad_cascade_df1_q15
+  with postShift 1, but a 32-bit accumulator so it stays
+  cheap on the M0+.
+ --------------------------------------------------------*/
+
+#include "biquad.h"
+
+// Butterworth sections by the bilinear transform (RBJ cookbook), fs 10 kHz.
+// High-pass sections have b1 = -2 b0 exactly so DC is rejected after
+// rounding, low-pass sections b1 = 2 b0.
+const biquad_band vortex_bands[] = {
+  // whole shedding range, ~50 Hz up: 2nd order high-pass at 100 Hz
+  // (60 Hz pickup -9 dB) and low-pass at 3 kHz (-29 dB at 4.5 kHz)
+  { "100 Hz - 3 kHz", 2, {
+    { 15672, -31344, 15672, -31313, 14991 },  // HP 100 Hz, Q 0.707
+    {  6412,  12824,  6412,   6054,  3208 },  // LP 3 kHz, Q 0.707
+  } },
+  // high flow only, ~300 gpm up: 4th order high-pass at 300 Hz (60 Hz
+  // pickup -56 dB) and the same low-pass
+  { "300 Hz - 3 kHz", 3, {
+    { 13843, -27686, 13843, -27438, 11548 },  // HP 300 Hz, Q 0.541
+    { 15152, -30304, 15152, -30034, 14192 },  // HP 300 Hz, Q 1.307
+    {  6412,  12824,  6412,   6054,  3208 },  // LP 3 kHz, Q 0.707
+  } },
+  // low flow only, below ~650 gpm: 2nd order high-pass at 50 Hz and 4th
+  // order low-pass at 600 Hz, for slow shedding in broadband noise
+  { "50 Hz - 600 Hz", 3, {
+    { 16024, -32048, 16024, -32040, 15672 },  // HP 50 Hz, Q 0.707
+    {   429,    858,   429, -22735,  8068 },  // LP 600 Hz, Q 0.541
+    {   504,   1008,   504, -26705, 12338 },  // LP 600 Hz, Q 1.307
+  } },
+};
+
+const int vortex_band_count = sizeof(vortex_bands) / sizeof(vortex_bands[0]);
+
+void biquad_reset(biquad_state *bs, const biquad_band *band) {
+  bs->band = band;
+  for( int k=0; k<BIQUAD_MAX_STAGES; k++ ) {
+    bs->x1[k] = 0;
+    bs->x2[k] = 0;
+    bs->y1[k] = 0;
+    bs->y2[k] = 0;
+    bs->err[k] = 0;
+  }
+}
+
+// Runs one sample through the cascade and returns the output.  x is at
+// most 15 bits, as is every section output (saturated), so with Q2.14
+// coefficients the five products of a section sum to below 2^31.
+//
+// The low-frequency high-pass poles sit close to z = 1, where plain
+// rounding of y would be amplified ~70x into a wandering offset on the
+// crossing threshold.  The bits dropped by the shift are added back on the
+// next sample instead (first order error feedback), which puts the
+// rounding noise's zero at DC and costs one add and one subtract.
+int biquad_sample(biquad_state *bs, int x) {
+  const biquad_band *band = bs->band;
+
+  for( int k=0; k<band->stages; k++ ) {
+    const biquad_coef *c = &band->coef[k];
+    int acc = c->b0 * x + c->b1 * bs->x1[k] + c->b2 * bs->x2[k]
+              - c->a1 * bs->y1[k] - c->a2 * bs->y2[k] + bs->err[k];
+    int y = acc >> BIQUAD_SHIFT;
+
+    bs->err[k] = acc - y * (1 << BIQUAD_SHIFT);
+    if( y > BIQUAD_LIMIT ) { y = BIQUAD_LIMIT; }
+    if( y < -BIQUAD_LIMIT ) { y = -BIQUAD_LIMIT; }
+    bs->x2[k] = bs->x1[k];
+    bs->x1[k] = x;
+    bs->y2[k] = bs->y1[k];
+    bs->y1[k] = y;
+    x = y;
+  }
+  return x;
+}
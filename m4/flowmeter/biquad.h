@@ -0,0 +1,39 @@
+#ifndef _biquad_h
+#define _biquad_h
+
+#define BIQUAD_MAX_STAGES 3     /* sections per band */
+#define BIQUAD_SHIFT 14         /* coefficients in Q2.14 */
+#define BIQUAD_LIMIT 16383      /* section outputs saturate here, 15 bits */
+#define BIQUAD_SETTLE 128       /* samples to ignore after a reset, 12.8 ms */
+
+// which of vortex_bands freq_sample uses: 0 the whole shedding range,
+// 1 high flow only, 2 low flow only (see biquad.cpp)
+#define VORTEX_BAND 0
+
+// one direct form I section:
+//   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+struct biquad_coef {
+  short b0, b1, b2, a1, a2;  // Q2.14, a0 = 1
+};
+
+struct biquad_band {
+  const char *name;
+  int stages;
+  biquad_coef coef[BIQUAD_MAX_STAGES];
+};
+
+extern const biquad_band vortex_bands[];
+extern const int vortex_band_count;
+
+// cascade state, one set of delays per section
+struct biquad_state {
+  const biquad_band *band;
+  int x1[BIQUAD_MAX_STAGES], x2[BIQUAD_MAX_STAGES];  // inputs, n-1 and n-2
+  int y1[BIQUAD_MAX_STAGES], y2[BIQUAD_MAX_STAGES];  // outputs, n-1 and n-2
+  int err[BIQUAD_MAX_STAGES];  // rounding error carried to the next sample
+};
+
+void biquad_reset(biquad_state *bs, const biquad_band *band);
+int biquad_sample(biquad_state *bs, int x);
+
+#endif
@@ -0,0 +1,60 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  cic.cpp
+
+  CIC decimator for the vortex channel when it is sampled
+  at CIC_DECIM times the 10 kHz tick (adc_cic_start).  A
+  third order CIC is a cascade of three R-sample moving
+  sums, so it averages down the adc noise and puts nulls
+  on every multiple of the output rate, where aliases
+  would come from, with no multiplies.
+
+  The same source builds on the host (host_test/test_cic),
+  so the host model is the target code.
+ --------------------------------------------------------*/
+
+#include "cic.h"
+
+cic_state vortex_cic;
+
+// decim is limited to 2..CIC_MAX_DECIM.  For R a power of two the gain
+// R^CIC_ORDER is undone exactly by the shift; otherwise the output is
+// scaled by R^CIC_ORDER / 2^shift, between 1/8 and 1.
+void cic_reset(cic_state *cs, int decim) {
+  int bits = 0;
+
+  if( decim < 2 ) { decim = 2; }
+  if( decim > CIC_MAX_DECIM ) { decim = CIC_MAX_DECIM; }
+  while( (1 << bits) < decim ) { bits++; }
+  for( int k=0; k<CIC_ORDER; k++ ) {
+    cs->integ[k] = 0;
+    cs->comb[k] = 0;
+  }
+  cs->decim = (unsigned char) decim;
+  cs->shift = (unsigned char) (CIC_ORDER * bits);
+  cs->phase = 0;
+}
+
+// Takes one input sample.  Every decim samples, writes an output in the
+// adc's 0-65535 scale to *out and returns 1; returns 0 otherwise.  The
+// first CIC_ORDER outputs are the filter filling.
+int cic_sample(cic_state *cs, unsigned short sample, unsigned short *out) {
+  unsigned int v = sample;
+
+  for( int k=0; k<CIC_ORDER; k++ ) {
+    cs->integ[k] += v;
+    v = cs->integ[k];
+  }
+  if( ++cs->phase < cs->decim ) {
+    return 0;
+  }
+  cs->phase = 0;
+
+  for( int k=0; k<CIC_ORDER; k++ ) {
+    unsigned int d = v - cs->comb[k];
+    cs->comb[k] = v;
+    v = d;
+  }
+  *out = (unsigned short) (v >> cs->shift);
+  return 1;
+}
@@ -0,0 +1,25 @@
+#ifndef _cic_h
+#define _cic_h
+
+#define CIC_ORDER 3             /* integrator/comb pairs */
+#define CIC_MAX_DECIM 32        /* gain R^3 of 16-bit input fits 32 bits up to here */
+#define CIC_DECIM 16            /* 160 ksps on the vortex channel down to the 10 kHz tick */
+#define CIC_TEMP_EVERY 256      /* outputs between temperature conversions, 25.6 ms */
+
+// cascaded integrator-comb decimator, only adds, subtracts and a shift.
+// Sums wrap modulo 2^32; the output is still exact because the comb
+// differences are, as long as R^CIC_ORDER * 65535 < 2^32.
+struct cic_state {
+  unsigned int integ[CIC_ORDER];  // integrators, at the input rate
+  unsigned int comb[CIC_ORDER];   // comb delays, at the output rate
+  unsigned char decim;   // R, input samples per output
+  unsigned char shift;   // output >> shift, ceil(CIC_ORDER log2 R)
+  unsigned char phase;   // input samples since the last output
+};
+
+extern cic_state vortex_cic;
+
+void cic_reset(cic_state *cs, int decim);
+int cic_sample(cic_state *cs, unsigned short sample, unsigned short *out);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef _const_seq_h
+#define _const_seq_h
+
+// Compile-time index lists for building const tables in C++11, which has
+// no loops in constexpr functions and no std::index_sequence.  A table
+// of N entries is an aggregate initialized from f(I)... over
+// make_index_seq<N>::type.  Built by doubling, so the template depth is
+// log2(N) and tables of a few thousand entries stay within the
+// compilers' limits.
+
+template<unsigned... I> struct index_seq {};
+
+template<class A, class B> struct index_seq_cat;
+template<unsigned... A, unsigned... B>
+struct index_seq_cat<index_seq<A...>, index_seq<B...> > {
+  typedef index_seq<A..., (sizeof...(A) + B)...> type;
+};
+
+template<unsigned N> struct make_index_seq {
+  typedef typename index_seq_cat<typename make_index_seq<N/2>::type,
+                                 typename make_index_seq<N - N/2>::type>::type type;
+};
+template<> struct make_index_seq<0> { typedef index_seq<> type; };
+template<> struct make_index_seq<1> { typedef index_seq<0> type; };
+
+#endif
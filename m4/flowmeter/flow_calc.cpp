@@ -1,9 +1,15 @@
 #include "flow_calc.h"
 #include "math_funcs.h"  /* alternate to math.h, much smaller */
+#include "sqrt_funcs.h"
+#include "flow_table.h"
+#include "water_table.h"
+#include <math.h>        /* sqrtf, calc_flow_float only */
 
 int temp = 0;
 int freq = 0;
+int freq_q8 = 0;
 int flow = 0;
+int flow_q8 = 0;
 
 // convert an ADC reading into temperature in C
 // See: KL25 reference manual p497
@@ -14,45 +20,335 @@ int calc_temp(unsigned int v_temp) {
 }
 
 // determines the frequency of vortex values sampled from the ADC
+//
+// The default FreqEstimator for blocks of VORTEX_INPUT_SIZE, the same
+// filter and counter at run time for any other length.  freq_sample below
+// is the same filter and detector, fed one sample at a time.
 int calc_freq(unsigned short * vals, int sample_count) {
-  unsigned char lp_win = 2;  // two on either side
-  //unsigned int cross_win = 2;
-  unsigned int lp[sample_count];
+  if( sample_count == VORTEX_INPUT_SIZE ) {
+    return FreqEstimator<VORTEX_INPUT_SIZE, VORTEX_LP_WIN>::calc(vals);
+  }
+  freq = (10000 * count_crossings<VORTEX_LP_WIN>(vals, sample_count)) / sample_count;
+  return freq;
+}
+
+vortex_state vortex;
+
+void freq_reset(vortex_state *vs) {
+  for( int j=0; j<VORTEX_LP_TAPS-1; j++ ) {
+    vs->taps[j] = 0;
+  }
+  vs->tap = 0;
+  vs->primed = 0;
+#ifdef VORTEX_PERIOD_MODE
+  vs->period_mode = 1;
+#else
+  vs->period_mode = 0;
+#endif
+#ifdef VORTEX_TRACKING
+  vs->tracking = 1;
+#else
+  vs->tracking = 0;
+#endif
+  vs->sum = 0;
+  vs->prev_sum = 0;
+#ifdef VORTEX_BIQUAD
+  vs->band = &vortex_bands[VORTEX_BAND];
+#else
+  vs->band = 0;
+#endif
+  biquad_reset(&vs->bq, vs->band);
+  vs->dc_acc = (VORTEX_LP_TAPS * VORTEX_CROSS_VAL) << VORTEX_DC_SHIFT;
+  vs->dev_acc = 0;
+  vs->cur_sign = 0;
+  vs->crossings = 0;
+  vs->timed = 0;
+  vs->t_cross = 0;
+  vs->t_valid = 0;
+  vs->t_first = 0;
+  vs->t_last = 0;
+  vs->samples = 0;
+  vs->window = VORTEX_INPUT_SIZE;
+  vs->freq = 0;
+  vs->freq_q8 = 0;
+  vs->publish = 1;
+}
 
-  // low pass
-  for( int i=lp_win; i+lp_win < sample_count; i++  ) {
-    lp[i] = 0;
-    for( int j=-lp_win; j<=lp_win; j++ ) {
-      lp[i] += vals[i+j];
+// The filter in front of the crossing detector.  Puts the filtered value
+// for this sample in *lp, on the scale of the moving sum (VORTEX_LP_TAPS
+// times an adc value), and returns 1, or returns 0 while still priming.
+//
+// The moving average is the one in calc_freq, its sum lagging 2 samples.
+// The biquad band-pass takes the sample centered and scaled to 13 bits and
+// its output is clamped to that range, then moved back to the adc scale,
+// so the detector's thresholds become y > 0 and y < 0 and the crossing
+// interpolation is unchanged.  Its cost per sample is five multiplies per
+// section whatever the band.  The first BIQUAD_SETTLE outputs after a reset
+// are skipped while the high-pass rings.
+static int vortex_filter(vortex_state *vs, unsigned short sample, unsigned int *lp) {
+  if( vs->band ) {
+    int y = biquad_sample(&vs->bq, ((int) sample - 0x8000) >> 3);
+    if( y > 4095 ) { y = 4095; }
+    if( y < -4095 ) { y = -4095; }
+    *lp = VORTEX_LP_TAPS * (VORTEX_CROSS_VAL + y * 8);
+    if( vs->primed < BIQUAD_SETTLE ) {
+      vs->primed++;  // start-up transient
+      return 0;
     }
-    lp[i] = lp[i]/(2*lp_win+1); // not necessary if we scale crossing or center on zero
+    return 1;
+  }
+
+  // sum covers the 5 samples centered 2 before this one
+  int primed = (vs->primed == VORTEX_LP_TAPS-1);
+  vs->sum += sample;
+  if( primed ) {
+    *lp = vs->sum;
+    vs->sum -= vs->taps[vs->tap];
+  } else {
+    vs->primed++;
   }
+  vs->taps[vs->tap] = sample;
+  if( ++vs->tap == VORTEX_LP_TAPS-1 ) { vs->tap = 0; }
+  return primed;
+}
+
+// Follows the offset and amplitude of the filtered value lp with two
+// exponential averages, shifts for coefficients:
+//   dc  += (lp - dc) / 2^VORTEX_DC_SHIFT
+//   dev += (|lp - dc| - dev) / 2^VORTEX_AMP_SHIFT
+// dev is the mean absolute deviation, 2/pi of the peak for a sine.  The
+// thresholds become dc +/- dev/4, about 1/6 of the peak either side, so an
+// offset or drift of the sensor moves the crossing point with it and noise
+// must swing a third of the signal to add a crossing.  Crossings are still
+// timed where the signal passes dc itself, where it is steepest and the
+// timestamp does not move with the amplitude.  Returns 0 when dev is below
+// VORTEX_MIN_DEV, too small to be vortex shedding.
+static int vortex_track(vortex_state *vs, unsigned int lp, unsigned int *cross_hi,
+                        unsigned int *cross_mid, unsigned int *cross_lo) {
+  int dc, dev, hyst;
+
+  vs->dc_acc += (int) lp - (vs->dc_acc >> VORTEX_DC_SHIFT);
+  dc = vs->dc_acc >> VORTEX_DC_SHIFT;
+  dev = (int) lp - dc;
+  if( dev < 0 ) { dev = -dev; }
+  vs->dev_acc += dev - (vs->dev_acc >> VORTEX_AMP_SHIFT);
+  dev = vs->dev_acc >> VORTEX_AMP_SHIFT;
+  if( dev < VORTEX_LP_TAPS * VORTEX_MIN_DEV ) { return 0; }
 
-  // center/zero crossing detector
-  unsigned int cross_val = 0x8000;  // adc data is 0-65535, choose center
-  int crossings = 0;
-  int cur_sign = 0;
-  for( int i=lp_win; i+lp_win < sample_count; i++  ) {
-    // could change to two stage if we set cur_sign =0 on change, and only update crossing after
-    if( (lp[i] > cross_val) && (cur_sign <= 0) ) {
-      cur_sign = 1;
-      crossings++;
-    } else if( (lp[i] < cross_val) && (cur_sign >= 0) ) {
-      cur_sign = -1;
-      //crossings++;  // positive crossings only
+  hyst = dev >> VORTEX_HYST_SHIFT;
+  *cross_hi = dc + hyst + 1;
+  *cross_mid = dc + 1;
+  *cross_lo = dc - hyst;
+  return 1;
+}
+
+// tracked offset of the vortex signal in adc counts, VORTEX_CROSS_VAL
+// when centered.  Behind the band-pass the sensor offset is filtered out
+// already and this shows what is left.
+int vortex_offset(vortex_state *vs) {
+  return (vs->dc_acc >> VORTEX_DC_SHIFT) / VORTEX_LP_TAPS;
+}
+
+// tracked peak amplitude of the vortex signal in adc counts, pi/2 times
+// the mean deviation (201/128)
+int vortex_amplitude(vortex_state *vs) {
+  return (((vs->dev_acc >> VORTEX_AMP_SHIFT) / VORTEX_LP_TAPS) * 201) >> 7;
+}
+
+// Incremental version of calc_freq: takes one vortex sample per 100 us tick
+// and estimates the frequency once every vs->window samples, into vs->freq
+// and vs->freq_q8 and, with vs->publish, the globals freq and freq_q8.
+// Returns 1 when the estimate was updated.  Constant work per sample and no
+// sample buffer beyond the filter taps.  vs->band selects the filter, see
+// vortex_filter.
+//
+// The filter and crossing state carry over from one window to the next, so
+// crossings at window edges are not lost.  In counting mode with the
+// moving average and fixed thresholds the first window after freq_reset
+// gives exactly calc_freq of the same samples.  Counts are quantized to
+// 10000/window Hz, 10 Hz for 1000 samples.
+//
+// In period mode each rising crossing is timestamped in 1/256 samples by
+// interpolating linearly between the filtered samples either side of the
+// threshold, and the frequency is the number of whole periods between the
+// first and last crossing in the window over the time they span.  On noisy
+// host test sines that is within 0.1 Hz for the 1000 sample window, and
+// within 0.25 Hz from a 250 sample window.
+// One divide per crossing and one 64-bit divide per window.  Windows with
+// fewer than two timed crossings fall back to counting.
+//
+// With vs->tracking the thresholds follow the signal (vortex_track) instead
+// of sitting either side of VORTEX_CROSS_VAL, and nothing is counted while
+// there is no signal.
+int freq_sample(vortex_state *vs, unsigned short sample) {
+  unsigned int cross_hi = VORTEX_LP_TAPS * (VORTEX_CROSS_VAL + 1);
+  unsigned int cross_lo = VORTEX_LP_TAPS * VORTEX_CROSS_VAL;
+  unsigned int cross_mid = cross_hi;
+  unsigned int lp;
+
+  if( vortex_filter(vs, sample, &lp) ) {
+    if( vs->tracking && !vortex_track(vs, lp, &cross_hi, &cross_mid, &cross_lo) ) {
+      // no signal: hold the crossing state, count nothing
+    } else {
+      if( vs->cur_sign < 0 ) {
+        // timestamp where the signal rose through cross_mid, Q.8 fraction
+        // of the way from the previous sample (at it, if a tracked
+        // threshold moved below it).  Falling back below cross_mid before
+        // reaching cross_hi voids that, the next rise counts.
+        if( lp < cross_mid ) {
+          vs->t_valid = 0;
+        } else if( !vs->t_valid ) {
+          vs->t_cross = (vs->samples - 1) * 256;  // -256 for a rise on the first sample
+          if( vs->prev_sum < cross_mid ) {
+            vs->t_cross += ((cross_mid - vs->prev_sum) << 8) / (lp - vs->prev_sum);
+          }
+          vs->t_valid = 1;
+        }
+      }
+      if( (lp >= cross_hi) && (vs->cur_sign <= 0) ) {
+        // no timestamp for the first trigger after a reset, which is no
+        // crossing
+        if( vs->cur_sign < 0 ) {
+          if( vs->timed == 0 ) { vs->t_first = vs->t_cross; }
+          vs->t_last = vs->t_cross;
+          vs->timed++;
+        }
+        vs->cur_sign = 1;
+        vs->crossings++;
+      } else if( (lp < cross_lo) && (vs->cur_sign >= 0) ) {
+        vs->cur_sign = -1;
+        vs->t_valid = 0;
+      }
     }
+    vs->prev_sum = lp;
   }
 
+  if( ++vs->samples < vs->window ) { return 0; }
+
   // time = samples / 10k (100us samples)
-  // freq = crossings/time
-  freq = (10000 * crossings) / sample_count;
-  return freq;
+  if( vs->period_mode && vs->timed >= 2 ) {
+    // (timed-1) periods in (t_last-t_first)/256 samples, Hz in Q.8
+    vs->freq_q8 = (int) (((unsigned long long) (vs->timed - 1) * (10000 << 16))
+                         / (unsigned int) (vs->t_last - vs->t_first));
+    vs->freq = (vs->freq_q8 + 128) >> 8;
+  } else {
+    vs->freq = (10000 * vs->crossings) / vs->samples;
+    vs->freq_q8 = ((10000 << 8) * vs->crossings) / vs->samples;
+  }
+  if( vs->publish ) {
+    freq_publish(vs);
+  }
+  vs->crossings = 0;
+  vs->timed = 0;
+  vs->t_cross -= vs->samples << 8;  // a pending rise, in the next window
+  vs->samples = 0;
+  return 1;
+}
+
+// Writes the last window's estimate to freq and freq_q8, for when another
+// estimator held them (see goertzel_track).
+void freq_publish(vortex_state *vs) {
+  freq = vs->freq;
+  freq_q8 = vs->freq_q8;
+}
+
+// Ticks whose samples never reached freq_sample, because the super loop
+// was still busy when the next tick came (timer0 counts them in
+// adc_overruns).  Their time still belongs to the window, or freq would
+// read low by the fraction lost.  A window that runs past vs->window this
+// way publishes on the next sample, over the samples it actually spans.
+void freq_lost(vortex_state *vs, int ticks) {
+  vs->samples += ticks;
+}
+
+// adc_test_data played back in a loop, one sample per call
+unsigned short vortex_test_sample(void) {
+  static int i = 0;
+  unsigned short sample = adc_test_data[i];
+  if( ++i == VORTEX_INPUT_SIZE ) { i = 0; }
+  return sample;
+}
+
+// calc_flow in integer math, the same model as calc_flow_float with no
+// soft-float.  Density and viscosity come from water_table.cpp by temp.
+// Q formats, with the worst case that sets each:
+//
+//   rho                   Q10.6   kg/m^3, water_density
+//   mu                    Q16.16  mPa s, water_viscosity, < 11 at -40 C
+//   d*pid/nu = d*pid*rho/mu, Reynolds number per Hz/St
+//                         Q14     < 2^26, at 125 C
+//   B = f*d*pid/nu = Re*St
+//                         Q6      < 2^31 with freq saturated at 8192 Hz
+//   beta = 1.0356/sqrt(B) Q1.31   < 0.12, from rsqrt_q31, at 1 Hz and -40 C
+//   x = beta^2 / (4 a)    Q1.31   < 0.012
+//   s = sqrt(4 a + beta^2)
+//                         Q1.31   < 1.05, 2 sqrt(a) (1 + x/2 - x^2/8 + x^3/16)
+//   c = (beta^2 + beta s) / (2 a)
+//                         Q1.31   < 0.25
+//   flow = 0.858521 f/a (1 + c)
+//                         Q12     gpm, < 2^27; rounded to Q8 in flow_q8 and
+//                                 truncated to flow like the float version
+//
+// The Strouhal relation is solved in closed form rather than iterated.
+// With a = 0.2684, St = a - 1.0356/sqrt(Re) and Re = B/St, y = sqrt(St)
+// is the positive root of y^2 + beta y - a = 0, so
+//
+//   1/St = (beta + s)^2 / (4 a^2) = (1 + c) / a
+//
+// which is one rsqrt_q31 and a fixed run of multiplies whatever the
+// input.  The series for s drops 5 x^4/128, under 1e-9 of s, and s only
+// enters through c.  flow_q8 keeps the result before truncation; it is
+// within 0.01 gpm of the plot_data.m model iterated to convergence over
+// the envelope (host_test/test_flow_fixed), the model flow_table.cpp is
+// generated from.
+int calc_flow(int freq, int temp) {
+  if( freq <= 0 ) {
+    flow_q8 = 0;
+    flow = 0;
+    return flow;
+  }
+  if( freq > FLOW_FREQ_MAX ) { freq = FLOW_FREQ_MAX; }
+  if( temp < FLOW_TEMP_MIN ) { temp = FLOW_TEMP_MIN; }
+  if( temp > FLOW_TEMP_MAX ) { temp = FLOW_TEMP_MAX; }
+
+  // (9) density and (10) viscosity
+  unsigned int rho_q6 = water_density[temp - WATER_TABLE_TMIN];
+  unsigned int mu_q16 = water_viscosity[temp - WATER_TABLE_TMIN];
+
+  // (8) Re = rho v pid / mu, and v = f d / St, so Re = B / St with
+  // B = f d pid rho / mu = f * 0.935482 rho / mu in mPa s.  The quotient
+  // comes out in Q6 and the remainder, under 2^20, takes it to Q14
+  unsigned int num = rho_q6 * 61308;  // 0.935482 * 2^16
+  unsigned int dk_q6 = num / mu_q16;
+  unsigned int rem = num - dk_q6 * mu_q16;
+  unsigned int dk_q14 = (dk_q6 << 8) + (rem << 8) / mu_q16;
+  unsigned int b_q6 = (unsigned int) ((freq * (unsigned long long) dk_q14) >> 8);
+  // 1.0356/sqrt(B) = 1.0356 * 8 / sqrt(B_q6)
+  unsigned int beta_q31 = (unsigned int) ((rsqrt_q31(b_q6) * (unsigned long long) FLOW_BETA_Q28) >> 28);
+
+  // (7) St = 0.2684 - 1.0356/sqrt(Re), solved for 1/St
+  unsigned int beta2_q31 = (unsigned int) (((unsigned long long) beta_q31 * beta_q31) >> 31);
+  unsigned int x_q31 = (unsigned int) ((beta2_q31 * (unsigned long long) FLOW_INV_4A_Q31) >> 31);
+  unsigned int x2_q31 = (unsigned int) (((unsigned long long) x_q31 * x_q31) >> 31);
+  unsigned int x3_q31 = (unsigned int) (((unsigned long long) x2_q31 * x_q31) >> 31);
+  unsigned int series_q31 = 0x80000000U + (x_q31 >> 1) - (x2_q31 >> 3) + (x3_q31 >> 4);
+  unsigned int s_q31 = (unsigned int) ((series_q31 * (unsigned long long) FLOW_SQRT_4A_Q31) >> 31);
+  unsigned int num_q31 = beta2_q31 + (unsigned int) (((unsigned long long) beta_q31 * s_q31) >> 31);
+  unsigned int c_q31 = (unsigned int) ((num_q31 * (unsigned long long) FLOW_INV_2A_Q30) >> 30);
+
+  // gpm = 2.45 pid_in^2 * 3.2808399 v = 0.858521 f / St
+  unsigned int base_q12 = (unsigned int) ((freq * (unsigned long long) FLOW_GPM_HZ_Q24) >> 12);
+  unsigned int flow_q12 = base_q12 + (unsigned int) (((unsigned long long) base_q12 * c_q31) >> 31);
+  flow_q8 = (int) ((flow_q12 + 8) >> 4);
+  flow = flow_q8 >> 8;
+  return flow;
 }
 
+// float reference for calc_flow
 // calculates flow rate based on vortex frequency and temperature
 // freq in Hz
 // temperature in celsius
-int calc_flow(int freq, int temp) {
+int calc_flow_float(int freq, int temp) {
   float T_C = temp;         // temperature in C, approx 73.4 F
   float T_K = T_C + 273.15; //  ...in Kelvin
 
@@ -66,17 +362,19 @@ int calc_flow(int freq, int temp) {
   // should be ~= 1e-3, 9.321e-4 @ 23 C
   // http://www.viscopedia.com/viscosity-tables/substances/water/
   // Note: pow10 calculates y=10^x, but takes 1000x and returns 1000y 
-  float viscosity = 2.4*10e-5 * (pow10((int) 1000*247.8/(T_K-140))/1000.0);
+  float viscosity = 2.4e-5 * (pow10((int) (1000*247.8/(T_K-140)))/1000.0);
 
   // (9) density of water in kg/m^3  (should be ~1000)
   float density = 1000 * (1 - (T_C+288.9414)/(508929.2*(T_C+68.12963))*(T_C-3.9863)*(T_C-3.9863));
 
-  // iterate to find solution
+  // iterate to find solution, at most FLOW_FLOAT_ITERATIONS times; each
+  // step shrinks the error by 1.0356/(2 St sqrt(Re)), 0.14 or less, so
+  // it settles within 5 steps over the envelope and the cap is a guard
   float error = 99999.0;
   float v_m = 10;  // % initail guess
   float v_m_prev; // previous guess
   float Re, St;
-  while( error > 0.0001 ) {
+  for( int i=0; i<FLOW_FLOAT_ITERATIONS && error > 0.0001; i++ ) {
     // (8) Reynolds number  (dimensionless: kg/m^3 * m/s * m * (m*s)/kg)
     //     typical for vortex: 10^5 - 10^7
     // NOTE: v_m is a guess
@@ -84,7 +382,9 @@ int calc_flow(int freq, int temp) {
 
     // (7) Strouhal number (dimensionless)
     //     should be 0.1 - 0.3
-    St = 0.2648 - 1.0356 / sqrt((unsigned int) Re);
+    //     St = 0.2684 - 1.0356/sqrt(Re), with the library sqrtf so this
+    //     stays independent of the rsqrt_q31 that calc_flow is built on
+    St = 0.2684f - 1.0356f / sqrtf(Re);
 
     v_m_prev = v_m;
     v_m = freq * d_m / St;
@@ -102,6 +402,54 @@ int calc_flow(int freq, int temp) {
   return flow;
 }
 
+// calc_flow from the generated surface in flow_table.cpp: bilinear
+// interpolation between the four entries around (freq, temp), with no
+// float and no divide.  freq_q8 is Hz in Q.8, clamped to the last column
+// (just under Nyquist); temp is clamped to the first and last rows.
+int flow_lookup(int freq_q8, int temp) {
+  const int fmax_q8 = (FLOW_TABLE_COLS - 1) << (FLOW_TABLE_FSHIFT + 8);
+  const int lo_q8 = (FLOW_TABLE_LO_COLS - 1) << (FLOW_TABLE_LO_FSHIFT + 8);
+  const int tmax = (FLOW_TABLE_ROWS - 1) << FLOW_TABLE_TSHIFT;
+  const int fbits = FLOW_TABLE_LO_FSHIFT + 8;  // weight across a column
+  const unsigned short *lo, *hi;
+  unsigned int col, fw;
+  int t = temp - FLOW_TABLE_TMIN;
+
+  if( freq_q8 < 0 ) { freq_q8 = 0; }
+  if( freq_q8 > fmax_q8 ) { freq_q8 = fmax_q8; }
+  if( t < 0 ) { t = 0; }
+  if( t > tmax ) { t = tmax; }
+
+  unsigned int row = t >> FLOW_TABLE_TSHIFT;
+  unsigned int tw = t & ((1 << FLOW_TABLE_TSHIFT) - 1);
+  if( row == FLOW_TABLE_ROWS - 1 ) { row--; tw = 1 << FLOW_TABLE_TSHIFT; }
+
+  // 2^fbits steps across a column of either table: all of Q.8 in the 8 Hz
+  // columns, 1/16 Hz in the 128 Hz columns
+  if( freq_q8 < lo_q8 ) {
+    col = freq_q8 >> fbits;
+    fw = freq_q8 & ((1 << fbits) - 1);
+    lo = &flow_table_lo[row][col];
+    hi = &flow_table_lo[row + 1][col];
+  } else {
+    col = freq_q8 >> (FLOW_TABLE_FSHIFT + 8);
+    fw = (freq_q8 >> (FLOW_TABLE_FSHIFT + 8 - fbits)) & ((1 << fbits) - 1);
+    if( col == FLOW_TABLE_COLS - 1 ) { col--; fw = 1 << fbits; }
+    lo = &flow_table[row][col];
+    hi = &flow_table[row + 1][col];
+  }
+
+  // across temperature, then frequency: under 2^16 * 2^3 * 2^11 = 2^30
+  unsigned int a = lo[0] * ((1 << FLOW_TABLE_TSHIFT) - tw) + hi[0] * tw;
+  unsigned int b = lo[1] * ((1 << FLOW_TABLE_TSHIFT) - tw) + hi[1] * tw;
+  unsigned int q = a * ((1 << fbits) - fw) + b * fw;
+
+  // rounded to whole gpm
+  const int shift = fbits + FLOW_TABLE_TSHIFT + FLOW_TABLE_FRAC;
+  flow = (int) ((q + (1 << (shift - 1))) >> shift);
+  return flow;
+}
+
 // fake data for testing: 1000Hz sine wave sampled at 100us => 3203 gpm
 unsigned short adc_test_data[VORTEX_INPUT_SIZE] = {
 0x7FFF,
@@ -1,16 +1,211 @@
 #ifndef _FLOW_CALC_H
 #define _FLOW_CALC_H
 
+#include <stddef.h>
+#include "biquad.h"
+
 extern int temp;
 extern int freq;
+extern int freq_q8;  /* freq in Q24.8, 1/256 Hz */
 extern int flow;
+extern int flow_q8;  /* flow in Q24.8, before truncation */
 extern unsigned short adc_test_data[];
 
+#define VORTEX_INPUT_SIZE 1000   /* samples per frequency measurement, 100 ms */
+#define VORTEX_LP_WIN 2          /* moving average: two on either side */
+#define VORTEX_LP_TAPS (2*VORTEX_LP_WIN + 1)
+#define VORTEX_CROSS_VAL 0x8000  /* adc data is 0-65535, choose center */
+#define VORTEX_DC_SHIFT 10       /* offset average over 2^10 samples, 102 ms */
+#define VORTEX_AMP_SHIFT 8       /* amplitude average over 2^8 samples, 26 ms */
+#define VORTEX_HYST_SHIFT 2      /* hysteresis +/- mean deviation / 4 */
+#define VORTEX_MIN_DEV 64        /* mean deviation below this is no signal, adc counts */
+
+// calc_flow limits and closed-form Strouhal solve, a = 0.2684.  The
+// constants come from plot_data.m's model, as in host_test/flow_model.h,
+// and test_flow_fixed checks them against it
+#define FLOW_FREQ_MAX 8192       /* Hz, freq saturates here */
+#define FLOW_TEMP_MIN (-40)      /* C, temp saturates to the operating range */
+#define FLOW_TEMP_MAX 125
+#define FLOW_BETA_Q28 2223934066U     /* 1.0356 * 8, Q4.28 */
+#define FLOW_INV_4A_Q31 2000264203U   /* 1 / (4 a) */
+#define FLOW_SQRT_4A_Q31 2225108112U  /* sqrt(4 a) */
+#define FLOW_INV_2A_Q30 2000264203U   /* 1 / (2 a), Q2.30 */
+#define FLOW_GPM_HZ_Q24 53664651U     /* 0.858521 / a, gpm per Hz at infinite Re */
+#define FLOW_FLOAT_ITERATIONS 32      /* cap on calc_flow_float's iteration */
+
+// feed adc_test_data to the vortex estimator instead of the sensor
+#define VORTEX_TEST_DATA
+
+// sample the vortex channel at CIC_DECIM times the tick and decimate it
+// with a CIC filter (cic.h, adc_cic_start), for lower noise and aliasing.
+// Takes TPM1 and the ADC interrupt.
+//#define VORTEX_CIC
+
+// pass the vortex samples through a sliding median (median.h) first, to
+// remove electrical spikes before they reach any frequency estimator.
+// Off by default: the window must stay well under a half period of the
+// highest shedding frequency in use, see VORTEX_MEDIAN_WIDTH
+//#define VORTEX_MEDIAN
+
+// band-pass the vortex signal with a biquad cascade (biquad.h) in
+// freq_sample, in place of the 5-tap moving average
+#define VORTEX_BIQUAD
+
+// track the offset and amplitude of the vortex signal in freq_sample and
+// center the crossing thresholds and a hysteresis band on them, rather
+// than crossing at VORTEX_CROSS_VAL
+#define VORTEX_TRACKING
+
+// measure the period between interpolated crossings rather than counting
+// crossings, for sub-Hz resolution
+#define VORTEX_PERIOD_MODE
+
+// refine the crossing estimate with the Goertzel tracker (goertzel.h)
+#define VORTEX_GOERTZEL
+
+// take the frequency from a real FFT of each block (spectrum.h) instead,
+// 2 KB of RAM for the block
+//#define VORTEX_FFT
+
+// compute flow from the frequency x temperature table (flow_table.h)
+// rather than with calc_flow's fixed-point solve.  The table ends at
+// 4992 Hz, just under the 5 kHz Nyquist limit of the tick, and holds its
+// last column above that where calc_flow goes on to FLOW_FREQ_MAX
+//#define VORTEX_FLOW_TABLE
+
+// Crossing counter behind a (2W+1)-tap moving average, one step per
+// filtered sample.  Rather than dividing the sum by 2W+1 for every sample
+// (a library call on the M0+), the crossing thresholds are scaled up by
+// taps = 2W+1:
+//   sum/taps > cross_val  <=>  sum >= taps*(cross_val+1)
+//   sum/taps < cross_val  <=>  sum <  taps*cross_val
+// which gives exactly the counts of filtering first with truncation.
+template<unsigned W>
+struct crossing_counter {
+  static constexpr unsigned int taps = 2*W + 1;
+  static constexpr unsigned int cross_hi = taps * (VORTEX_CROSS_VAL + 1);
+  static constexpr unsigned int cross_lo = taps * VORTEX_CROSS_VAL;
+  unsigned int sum;
+  int cur_sign;
+  int crossings;
+
+  // sum covers the taps centered on one sample once in is added
+  void step(unsigned short in, unsigned short out) {
+    sum += in;
+    if( (sum >= cross_hi) && (cur_sign <= 0) ) {
+      cur_sign = 1;
+      crossings++;
+    } else if( (sum < cross_lo) && (cur_sign >= 0) ) {
+      cur_sign = -1;
+      //crossings++;  // positive crossings only
+    }
+    sum -= out;
+  }
+};
+
+// Positive-going center crossings of vals[0..n) after the moving average,
+// in one streaming pass with O(1) state and no buffer of filtered samples.
+// Inlined into each FreqEstimator, where W and n are constants: the
+// priming loop unrolls completely and the main loop runs four samples per
+// iteration with a constant trip count.
+template<unsigned W>
+inline int count_crossings(const unsigned short *vals, int n) {
+  crossing_counter<W> c = { 0, 0, 0 };
+  int i = W;
+
+  if( n < (int) c.taps ) { return 0; }
+  for( unsigned j=0; j<c.taps-1; j++ ) {
+    c.sum += vals[j];
+  }
+  for( ; i+3+(int)W < n; i+=4 ) {
+    c.step(vals[i+W], vals[i-W]);
+    c.step(vals[i+1+W], vals[i+1-W]);
+    c.step(vals[i+2+W], vals[i+2-W]);
+    c.step(vals[i+3+W], vals[i+3-W]);
+  }
+  for( ; i+(int)W < n; i++ ) {
+    c.step(vals[i+W], vals[i-W]);
+  }
+  return c.crossings;
+}
+
+// crossing count frequency estimator for blocks of N samples behind a
+// moving average of 2W+1 taps, both fixed at compile time.  calc_freq is
+// FreqEstimator<VORTEX_INPUT_SIZE, VORTEX_LP_WIN>::calc for full blocks.
+// Defined here in full so any module can use its own N and W.
+template<size_t N, unsigned W>
+struct FreqEstimator {
+  unsigned short block[N];  // samples collected by push
+  size_t count;             // in block
+
+  static int crossings(const unsigned short *vals);  // N samples
+  static int calc(const unsigned short *vals);       // publishes freq
+  int push(unsigned short sample);
+};
+
+template<size_t N, unsigned W>
+inline int FreqEstimator<N, W>::crossings(const unsigned short *vals) {
+  return count_crossings<W>(vals, N);
+}
+
+// time = samples / 10k (100us samples)
+// freq = crossings/time
+template<size_t N, unsigned W>
+inline int FreqEstimator<N, W>::calc(const unsigned short *vals) {
+  freq = (10000 * crossings(vals)) / (int) N;
+  return freq;
+}
+
+// collects one sample per call into block and runs calc on it once N
+// have arrived, returns 1 then
+template<size_t N, unsigned W>
+inline int FreqEstimator<N, W>::push(unsigned short sample) {
+  block[count] = sample;
+  if( ++count < N ) { return 0; }
+  count = 0;
+  calc(block);
+  return 1;
+}
+
+// incremental vortex frequency estimator, one sample per 100 us tick
+struct vortex_state {
+  unsigned short taps[VORTEX_LP_TAPS-1];  // previous samples, ring buffer
+  unsigned char tap;      // oldest sample in taps
+  unsigned char primed;   // samples seen, up to VORTEX_LP_TAPS-1 or BIQUAD_SETTLE
+  unsigned char period_mode;  // 1 to time crossings, 0 to count them
+  unsigned char tracking;     // 1 for adaptive thresholds, 0 for fixed
+  unsigned int sum;       // moving sum, taps plus the newest sample
+  unsigned int prev_sum;  // filtered value one sample earlier, sum scale
+  const biquad_band *band;  // band-pass filter, 0 for the moving average
+  biquad_state bq;
+  int dc_acc;             // offset of the filtered value, sum scale << VORTEX_DC_SHIFT
+  int dev_acc;            // its mean absolute deviation, << VORTEX_AMP_SHIFT
+  int cur_sign;           // side of the crossing value, 0 at start
+  int crossings;          // in the current window
+  int timed;              // crossings with a timestamp, in the window
+  int t_first, t_last;    // first/last rising crossing, samples in Q.8
+  int t_cross;            // pending rising crossing, samples in Q.8
+  int t_valid;            // 1 if t_cross belongs to the rise in progress
+  int samples;            // in the current window
+  int window;             // samples per published frequency
+  int freq, freq_q8;      // last window's estimate, Hz and Hz in Q.8
+  int publish;            // 1 to also write it to freq and freq_q8
+};
+
+extern vortex_state vortex;
+
 int calc_temp(unsigned int v_temp);
 int calc_freq(unsigned short *, int);
+void freq_reset(vortex_state *vs);
+int freq_sample(vortex_state *vs, unsigned short sample);
+void freq_lost(vortex_state *vs, int ticks);
+void freq_publish(vortex_state *vs);
+int vortex_offset(vortex_state *vs);
+int vortex_amplitude(vortex_state *vs);
+unsigned short vortex_test_sample(void);
 int calc_flow(int, int);
-
-#define VORTEX_INPUT_SIZE 1000
+int calc_flow_float(int, int);
+int flow_lookup(int freq_q8, int temp);
 
 #define V_BG                    (1000U)     /*! BANDGAP voltage in mV (trim to 1.0V) */
 #define V_TEMP25                (716U)      /*! Typical VTEMP25 in mV */
@@ -0,0 +1,247 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  flow_table.cpp
+
+  Generated by host_test/gen_flow_table, do not edit.
+  Flow in gpm (Q14.2) from the plot_data.m model, one
+  row per 8 C from -48 C, one column per 128 Hz, and
+  per 8 Hz below 128 Hz.
+ --------------------------------------------------------*/
+
+#include "flow_table.h"
+
+const unsigned short flow_table[FLOW_TABLE_ROWS][FLOW_TABLE_COLS] = {
+  { // -48 C
+        0,  1681,  3337,  4989,  6638,  8286,  9933, 11579, 13224, 14870,
+    16514, 18159, 19803, 21447, 23090, 24734, 26377, 28020, 29663, 31305,
+    32948, 34590, 36233, 37875, 39517, 41159, 42801, 44443, 46085, 47727,
+    49369, 51010, 52652, 54293, 55935, 57576, 59217, 60859, 62500, 64141,
+  },
+  { // -40 C
+        0,  1670,  3321,  4969,  6615,  8260,  9905, 11549, 13192, 14835,
+    16478, 18121, 19763, 21406, 23048, 24690, 26331, 27973, 29614, 31256,
+    32897, 34538, 36180, 37821, 39462, 41103, 42743, 44384, 46025, 47666,
+    49306, 50947, 52588, 54228, 55869, 57509, 59149, 60790, 62430, 64070,
+  },
+  { // -32 C
+        0,  1663,  3311,  4956,  6601,  8244,  9887, 11530, 13172, 14814,
+    16456, 18097, 19739, 21380, 23021, 24662, 26303, 27944, 29584, 31225,
+    32866, 34506, 36146, 37787, 39427, 41067, 42707, 44347, 45988, 47628,
+    49268, 50908, 52547, 54187, 55827, 57467, 59107, 60747, 62386, 64026,
+  },
+  { // -24 C
+        0,  1658,  3304,  4948,  6591,  8234,  9876, 11517, 13159, 14800,
+    16441, 18082, 19722, 21363, 23003, 24644, 26284, 27924, 29564, 31204,
+    32844, 34484, 36124, 37764, 39404, 41043, 42683, 44323, 45962, 47602,
+    49242, 50881, 52521, 54160, 55800, 57439, 59078, 60718, 62357, 63997,
+  },
+  { // -16 C
+        0,  1655,  3299,  4942,  6584,  8226,  9867, 11508, 13149, 14790,
+    16430, 18071, 19711, 21351, 22991, 24631, 26271, 27910, 29550, 31190,
+    32829, 34469, 36108, 37748, 39387, 41027, 42666, 44306, 45945, 47584,
+    49223, 50863, 52502, 54141, 55780, 57419, 59058, 60698, 62337, 63976,
+  },
+  { // -8 C
+        0,  1652,  3296,  4938,  6580,  8221,  9861, 11502, 13142, 14782,
+    16423, 18062, 19702, 21342, 22982, 24621, 26261, 27900, 29540, 31179,
+    32818, 34458, 36097, 37736, 39375, 41015, 42654, 44293, 45932, 47571,
+    49210, 50849, 52488, 54127, 55766, 57405, 59044, 60683, 62322, 63960,
+  },
+  { // 0 C
+        0,  1650,  3293,  4935,  6576,  8217,  9857, 11497, 13137, 14777,
+    16417, 18056, 19696, 21335, 22975, 24614, 26253, 27893, 29532, 31171,
+    32810, 34449, 36088, 37727, 39366, 41005, 42644, 44283, 45922, 47561,
+    49200, 50839, 52478, 54116, 55755, 57394, 59033, 60671, 62310, 63949,
+  },
+  { // 8 C
+        0,  1649,  3291,  4932,  6573,  8213,  9853, 11493, 13133, 14773,
+    16412, 18052, 19691, 21330, 22969, 24609, 26248, 27887, 29526, 31165,
+    32804, 34443, 36082, 37721, 39359, 40998, 42637, 44276, 45915, 47553,
+    49192, 50831, 52469, 54108, 55747, 57386, 59024, 60663, 62301, 63940,
+  },
+  { // 16 C
+        0,  1648,  3290,  4930,  6571,  8211,  9851, 11490, 13130, 14769,
+    16409, 18048, 19687, 21326, 22965, 24604, 26243, 27882, 29521, 31160,
+    32799, 34438, 36076, 37715, 39354, 40993, 42631, 44270, 45909, 47547,
+    49186, 50824, 52463, 54102, 55740, 57379, 59017, 60656, 62294, 63933,
+  },
+  { // 24 C
+        0,  1647,  3288,  4929,  6569,  8209,  9848, 11488, 13127, 14767,
+    16406, 18045, 19684, 21323, 22962, 24601, 26240, 27878, 29517, 31156,
+    32795, 34433, 36072, 37711, 39349, 40988, 42627, 44265, 45904, 47542,
+    49181, 50819, 52458, 54096, 55735, 57373, 59012, 60650, 62289, 63927,
+  },
+  { // 32 C
+        0,  1646,  3287,  4927,  6567,  8207,  9847, 11486, 13125, 14764,
+    16403, 18042, 19681, 21320, 22959, 24598, 26237, 27875, 29514, 31153,
+    32791, 34430, 36069, 37707, 39346, 40984, 42623, 44261, 45900, 47538,
+    49177, 50815, 52454, 54092, 55731, 57369, 59007, 60646, 62284, 63923,
+  },
+  { // 40 C
+        0,  1645,  3286,  4926,  6566,  8206,  9845, 11484, 13123, 14762,
+    16401, 18040, 19679, 21318, 22957, 24595, 26234, 27873, 29511, 31150,
+    32788, 34427, 36066, 37704, 39343, 40981, 42620, 44258, 45896, 47535,
+    49173, 50812, 52450, 54089, 55727, 57365, 59004, 60642, 62280, 63919,
+  },
+  { // 48 C
+        0,  1645,  3286,  4925,  6565,  8205,  9844, 11483, 13122, 14761,
+    16400, 18038, 19677, 21316, 22955, 24593, 26232, 27871, 29509, 31148,
+    32786, 34425, 36063, 37702, 39340, 40978, 42617, 44255, 45894, 47532,
+    49170, 50809, 52447, 54085, 55724, 57362, 59000, 60639, 62277, 63915,
+  },
+  { // 56 C
+        0,  1644,  3285,  4925,  6564,  8204,  9843, 11482, 13121, 14759,
+    16398, 18037, 19676, 21314, 22953, 24592, 26230, 27869, 29507, 31146,
+    32784, 34423, 36061, 37699, 39338, 40976, 42615, 44253, 45891, 47530,
+    49168, 50806, 52445, 54083, 55721, 57360, 58998, 60636, 62274, 63913,
+  },
+  { // 64 C
+        0,  1644,  3284,  4924,  6563,  8203,  9842, 11481, 13120, 14758,
+    16397, 18036, 19674, 21313, 22952, 24590, 26229, 27867, 29506, 31144,
+    32782, 34421, 36059, 37698, 39336, 40974, 42613, 44251, 45889, 47528,
+    49166, 50804, 52442, 54081, 55719, 57357, 58995, 60634, 62272, 63910,
+  },
+  { // 72 C
+        0,  1644,  3284,  4923,  6563,  8202,  9841, 11480, 13119, 14757,
+    16396, 18035, 19673, 21312, 22950, 24589, 26227, 27866, 29504, 31143,
+    32781, 34419, 36058, 37696, 39334, 40973, 42611, 44249, 45888, 47526,
+    49164, 50802, 52441, 54079, 55717, 57355, 58993, 60632, 62270, 63908,
+  },
+  { // 80 C
+        0,  1643,  3283,  4923,  6562,  8201,  9840, 11479, 13118, 14756,
+    16395, 18034, 19672, 21311, 22949, 24588, 26226, 27865, 29503, 31141,
+    32780, 34418, 36056, 37695, 39333, 40971, 42610, 44248, 45886, 47524,
+    49163, 50801, 52439, 54077, 55715, 57354, 58992, 60630, 62268, 63906,
+  },
+  { // 88 C
+        0,  1643,  3283,  4923,  6562,  8201,  9840, 11478, 13117, 14756,
+    16394, 18033, 19671, 21310, 22948, 24587, 26225, 27863, 29502, 31140,
+    32779, 34417, 36055, 37693, 39332, 40970, 42608, 44246, 45885, 47523,
+    49161, 50799, 52438, 54076, 55714, 57352, 58990, 60628, 62267, 63905,
+  },
+  { // 96 C
+        0,  1643,  3283,  4922,  6561,  8200,  9839, 11478, 13116, 14755,
+    16394, 18032, 19671, 21309, 22947, 24586, 26224, 27863, 29501, 31139,
+    32778, 34416, 36054, 37692, 39331, 40969, 42607, 44245, 45883, 47522,
+    49160, 50798, 52436, 54074, 55713, 57351, 58989, 60627, 62265, 63903,
+  },
+  { // 104 C
+        0,  1643,  3282,  4922,  6561,  8200,  9839, 11477, 13116, 14754,
+    16393, 18031, 19670, 21308, 22947, 24585, 26223, 27862, 29500, 31138,
+    32777, 34415, 36053, 37691, 39330, 40968, 42606, 44244, 45882, 47521,
+    49159, 50797, 52435, 54073, 55711, 57350, 58988, 60626, 62264, 63902,
+  },
+  { // 112 C
+        0,  1643,  3282,  4921,  6561,  8199,  9838, 11477, 13115, 14754,
+    16392, 18031, 19669, 21308, 22946, 24584, 26223, 27861, 29499, 31138,
+    32776, 34414, 36052, 37691, 39329, 40967, 42605, 44243, 45882, 47520,
+    49158, 50796, 52434, 54072, 55710, 57349, 58987, 60625, 62263, 63901,
+  },
+  { // 120 C
+        0,  1642,  3282,  4921,  6560,  8199,  9838, 11476, 13115, 14753,
+    16392, 18030, 19669, 21307, 22945, 24584, 26222, 27860, 29499, 31137,
+    32775, 34413, 36052, 37690, 39328, 40966, 42604, 44243, 45881, 47519,
+    49157, 50795, 52433, 54071, 55709, 57348, 58986, 60624, 62262, 63900,
+  },
+  { // 128 C
+        0,  1642,  3282,  4921,  6560,  8199,  9837, 11476, 13115, 14753,
+    16391, 18030, 19668, 21307, 22945, 24583, 26222, 27860, 29498, 31136,
+    32775, 34413, 36051, 37689, 39327, 40965, 42604, 44242, 45880, 47518,
+    49156, 50794, 52432, 54071, 55709, 57347, 58985, 60623, 62261, 63899,
+  },
+};
+
+const unsigned short flow_table_lo[FLOW_TABLE_ROWS][FLOW_TABLE_LO_COLS] = {
+  { // -48 C
+        0,   114,   221,   326,   432,   537,   641,   746,   850,   954,
+     1058,  1162,  1266,  1370,  1474,  1578,  1681,
+  },
+  { // -40 C
+        0,   111,   216,   321,   426,   530,   634,   738,   842,   945,
+     1049,  1153,  1256,  1360,  1463,  1567,  1670,
+  },
+  { // -32 C
+        0,   109,   214,   318,   422,   526,   630,   733,   837,   940,
+     1043,  1147,  1250,  1353,  1456,  1560,  1663,
+  },
+  { // -24 C
+        0,   108,   212,   316,   420,   523,   627,   730,   833,   936,
+     1040,  1143,  1246,  1349,  1452,  1555,  1658,
+  },
+  { // -16 C
+        0,   107,   211,   314,   418,   521,   624,   728,   831,   934,
+     1037,  1140,  1243,  1346,  1449,  1552,  1655,
+  },
+  { // -8 C
+        0,   106,   210,   313,   417,   520,   623,   726,   829,   932,
+     1035,  1138,  1241,  1344,  1446,  1549,  1652,
+  },
+  { // 0 C
+        0,   106,   209,   313,   416,   519,   622,   725,   828,   931,
+     1033,  1136,  1239,  1342,  1445,  1547,  1650,
+  },
+  { // 8 C
+        0,   105,   209,   312,   415,   518,   621,   724,   827,   930,
+     1032,  1135,  1238,  1341,  1443,  1546,  1649,
+  },
+  { // 16 C
+        0,   105,   208,   311,   414,   517,   620,   723,   826,   929,
+     1031,  1134,  1237,  1340,  1442,  1545,  1648,
+  },
+  { // 24 C
+        0,   105,   208,   311,   414,   517,   620,   722,   825,   928,
+     1031,  1133,  1236,  1339,  1441,  1544,  1647,
+  },
+  { // 32 C
+        0,   104,   208,   311,   414,   516,   619,   722,   825,   927,
+     1030,  1133,  1235,  1338,  1441,  1543,  1646,
+  },
+  { // 40 C
+        0,   104,   207,   310,   413,   516,   619,   722,   824,   927,
+     1030,  1132,  1235,  1338,  1440,  1543,  1645,
+  },
+  { // 48 C
+        0,   104,   207,   310,   413,   516,   619,   721,   824,   927,
+     1029,  1132,  1234,  1337,  1440,  1542,  1645,
+  },
+  { // 56 C
+        0,   104,   207,   310,   413,   516,   618,   721,   824,   926,
+     1029,  1131,  1234,  1337,  1439,  1542,  1644,
+  },
+  { // 64 C
+        0,   104,   207,   310,   413,   515,   618,   721,   823,   926,
+     1029,  1131,  1234,  1336,  1439,  1541,  1644,
+  },
+  { // 72 C
+        0,   104,   207,   310,   412,   515,   618,   720,   823,   926,
+     1028,  1131,  1233,  1336,  1439,  1541,  1644,
+  },
+  { // 80 C
+        0,   104,   207,   310,   412,   515,   618,   720,   823,   925,
+     1028,  1131,  1233,  1336,  1438,  1541,  1643,
+  },
+  { // 88 C
+        0,   104,   207,   309,   412,   515,   617,   720,   823,   925,
+     1028,  1130,  1233,  1336,  1438,  1541,  1643,
+  },
+  { // 96 C
+        0,   104,   207,   309,   412,   515,   617,   720,   823,   925,
+     1028,  1130,  1233,  1335,  1438,  1540,  1643,
+  },
+  { // 104 C
+        0,   104,   206,   309,   412,   515,   617,   720,   822,   925,
+     1028,  1130,  1233,  1335,  1438,  1540,  1643,
+  },
+  { // 112 C
+        0,   104,   206,   309,   412,   514,   617,   720,   822,   925,
+     1027,  1130,  1232,  1335,  1438,  1540,  1643,
+  },
+  { // 120 C
+        0,   104,   206,   309,   412,   514,   617,   720,   822,   925,
+     1027,  1130,  1232,  1335,  1437,  1540,  1642,
+  },
+  { // 128 C
+        0,   103,   206,   309,   412,   514,   617,   719,   822,   925,
+     1027,  1130,  1232,  1335,  1437,  1540,  1642,
+  },
+};
@@ -0,0 +1,21 @@
+#ifndef _flow_table_h
+#define _flow_table_h
+
+// Flow surface sampled from the plot_data.m model by
+// host_test/gen_flow_table (make flow_table), for flow_lookup.
+// Entries are flow in gpm in Q14.2.  The Strouhal number falls off at
+// low Reynolds numbers, so flow bends near zero; below 128 Hz a second
+// table with 8 Hz columns keeps the interpolation within 0.1%.
+#define FLOW_TABLE_FSHIFT 7      /* 128 Hz between columns */
+#define FLOW_TABLE_COLS 40       /* 0 .. 4992 Hz */
+#define FLOW_TABLE_LO_FSHIFT 3   /* 8 Hz between columns */
+#define FLOW_TABLE_LO_COLS 17    /* 0 .. 128 Hz */
+#define FLOW_TABLE_TSHIFT 3      /* 8 C between rows */
+#define FLOW_TABLE_TMIN (-48)    /* first row, C */
+#define FLOW_TABLE_ROWS 23       /* -48 .. 128 C */
+#define FLOW_TABLE_FRAC 2        /* fraction bits of an entry */
+
+extern const unsigned short flow_table[FLOW_TABLE_ROWS][FLOW_TABLE_COLS];
+extern const unsigned short flow_table_lo[FLOW_TABLE_ROWS][FLOW_TABLE_LO_COLS];
+
+#endif
@@ -0,0 +1,179 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  goertzel.cpp
+
+  Vortex shedding frequency tracker: a small bank of
+  Goertzel filters (single DFT bins) centered on the
+  current estimate, refined by interpolating between the
+  strongest bin and its neighbour.  Fixed point, plain
+  C++ so it also builds on the host (see ../host_test).
+ --------------------------------------------------------*/
+
+#include "goertzel.h"
+#include "flow_calc.h"   // freq, freq_q8
+#include "sqrt_funcs.h"
+
+goertzel_state goertzel;
+
+// bin spacing Fs/N, Hz in Q.8
+#define GOERTZEL_SPACING_Q8 ((GOERTZEL_FS << 8) / GOERTZEL_BLOCK)
+
+#define PI_Q30 3373259426LL  /* pi in Q30 */
+
+// cos(x) in Q30 for x in [0, pi/2] in Q30, Taylor series to x^14 (error
+// below 1e-10).  Only runs when the bank is re-centered, once per block.
+static long long cos_q30(long long x) {
+  static const int denom[] = { 2, 12, 30, 56, 90, 132, 182 };  // (2k-1)(2k)
+  long long y = (x * x) >> 30;
+  long long c = 1LL << 30;
+
+  // 1 - y/2 (1 - y/12 (1 - y/30 (...)))
+  for( int k=6; k>=0; k-- ) {
+    c = (1LL << 30) - ((y * c) >> 30) / denom[k];
+  }
+  return c;
+}
+
+// 2cos(2 pi f / Fs) in Q2.29 for f in Hz Q.8, 0 <= f <= Fs/2
+static int goertzel_coef(int f_q8) {
+  long long w = (f_q8 * 2 * PI_Q30) / (GOERTZEL_FS << 8);  // Q30 radians
+  long long c;
+
+  if( w <= PI_Q30/2 ) {
+    c = cos_q30(w);
+  } else {
+    c = -cos_q30(PI_Q30 - w);
+  }
+  return (int) c;  // 2cos in Q2.29 == cos in Q30
+}
+
+// centers the bank on f_q8 and starts a new block
+static void goertzel_center(goertzel_state *gs, int f_q8) {
+  const int mid = GOERTZEL_BINS / 2;
+  const int lo = (mid + 1) * GOERTZEL_SPACING_Q8;
+  const int hi = ((GOERTZEL_FS / 2) << 8) - lo;
+
+  // keep every bin strictly between 0 and Fs/2
+  if( f_q8 < lo ) { f_q8 = lo; }
+  if( f_q8 > hi ) { f_q8 = hi; }
+  gs->center_q8 = f_q8;
+  for( int k=0; k<GOERTZEL_BINS; k++ ) {
+    gs->coef[k] = goertzel_coef(f_q8 + (k - mid) * GOERTZEL_SPACING_Q8);
+    gs->s1[k] = 0;
+    gs->s2[k] = 0;
+  }
+  gs->samples = 0;
+}
+
+void goertzel_reset(goertzel_state *gs) {
+  for( int k=0; k<GOERTZEL_BINS; k++ ) {
+    gs->coef[k] = 0;
+    gs->s1[k] = 0;
+    gs->s2[k] = 0;
+    gs->mag[k] = 0;
+  }
+  gs->center_q8 = 0;
+  gs->samples = 0;
+  gs->locked = 0;
+  gs->freq_q8 = 0;
+}
+
+// starts tracking from a coarse estimate, e.g. from freq_sample
+void goertzel_seed(goertzel_state *gs, int freq_q8) {
+  goertzel_center(gs, freq_q8);
+  gs->locked = 1;
+}
+
+// Takes one vortex sample per 100 us tick.  Every GOERTZEL_BLOCK samples
+// the bin magnitudes are compared, the estimate is published to freq and
+// freq_q8, the bank re-centers on it and 1 is returned.  Does nothing
+// until seeded, and unlocks again if the peak falls below GOERTZEL_MIN_MAG.
+//
+// Per sample each bin costs one 32x32->64 multiply:
+//   s[n] = x[n] + 2cos(w)*s[n-1] - s[n-2]
+// and at the end of the block |X|^2 = s1^2 + s2^2 - 2cos(w)*s1*s2.  The
+// input is centered and scaled to 14 bits, which keeps s in 32 bits for
+// any tone above ~5 Hz over the 1000 sample block.
+//
+// For a tone between bins k and k+1 of a rectangular window, the
+// magnitudes satisfy |X[k+1]| / (|X[k]| + |X[k+1]|) = offset from bin k in
+// bins, so the strongest bin and its larger neighbour give the frequency
+// well inside the 10 Hz bin spacing.  Harmonics and out of band noise
+// land far outside the +/-2 bin bank and are attenuated by the DFT, where
+// they would add false zero crossings.
+int goertzel_sample(goertzel_state *gs, unsigned short sample) {
+  const int mid = GOERTZEL_BINS / 2;
+  int x = ((int) sample - 0x8000) >> 2;
+  long long p, power[GOERTZEL_BINS], max_power = 0;
+  int k, peak = 0, nb, shift = 0, f_q8;
+  unsigned int peak_mag;
+
+  if( !gs->locked ) { return 0; }
+
+  for( k=0; k<GOERTZEL_BINS; k++ ) {
+    int s0 = x + (int) (((long long) gs->coef[k] * gs->s1[k]) >> 29) - gs->s2[k];
+    gs->s2[k] = gs->s1[k];
+    gs->s1[k] = s0;
+  }
+  if( ++gs->samples < GOERTZEL_BLOCK ) { return 0; }
+
+  // power per bin, strongest bin
+  for( k=0; k<GOERTZEL_BINS; k++ ) {
+    long long s1 = gs->s1[k], s2 = gs->s2[k];
+    p = s1*s1 + s2*s2 - ((gs->coef[k] * s1) >> 29) * s2;
+    power[k] = (p > 0) ? p : 0;
+    if( power[k] > max_power ) {
+      max_power = power[k];
+      peak = k;
+    }
+  }
+
+  // magnitudes, all scaled by the same even shift to fit sqrt_clz
+  while( (max_power >> shift) > 0xffffffffLL ) { shift += 2; }
+  for( k=0; k<GOERTZEL_BINS; k++ ) {
+    gs->mag[k] = sqrt_clz((unsigned int) (power[k] >> shift));
+  }
+  peak_mag = gs->mag[peak] << (shift >> 1);
+  if( peak_mag < GOERTZEL_MIN_MAG ) {
+    gs->locked = 0;  // no signal, wait to be seeded again
+    return 0;
+  }
+
+  f_q8 = gs->center_q8 + (peak - mid) * GOERTZEL_SPACING_Q8;
+  if( peak > 0 && peak < GOERTZEL_BINS-1 ) {
+    nb = (gs->mag[peak+1] > gs->mag[peak-1]) ? peak+1 : peak-1;
+    int offset_q8 = (int) ((gs->mag[nb] * (unsigned int) GOERTZEL_SPACING_Q8)
+                           / (gs->mag[peak] + gs->mag[nb]));
+    f_q8 += (nb > peak) ? offset_q8 : -offset_q8;
+  }
+  // at an edge bin the tone is outside the bank: publish the edge and
+  // re-center on it, which follows a step of up to 2 bins per block
+
+  gs->freq_q8 = f_q8;
+  freq_q8 = f_q8;
+  freq = (f_q8 + 128) >> 8;
+  goertzel_center(gs, f_q8);
+  return 1;
+}
+
+// The crossing estimator and the tracker together, one sample each.
+// Exactly one of them publishes freq and freq_q8: the tracker while it is
+// locked, the crossings otherwise.  The crossing estimate is still made
+// and kept in vs while locked, to re-seed from and to fall back on at
+// once when the tracker loses the signal.  Returns 1 when freq changed.
+int goertzel_track(goertzel_state *gs, vortex_state *vs, unsigned short sample) {
+  int new_freq;
+
+  vs->publish = !gs->locked;
+  new_freq = freq_sample(vs, sample);
+  if( gs->locked ) {
+    new_freq = goertzel_sample(gs, sample);
+    if( !gs->locked ) {
+      freq_publish(vs);
+      new_freq = 1;
+    }
+  } else if( new_freq ) {
+    goertzel_seed(gs, vs->freq_q8);
+  }
+  return new_freq;
+}
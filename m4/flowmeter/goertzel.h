@@ -0,0 +1,30 @@
+#ifndef _goertzel_h
+#define _goertzel_h
+
+#include "flow_calc.h"   // vortex_state
+
+#define GOERTZEL_BINS 5        /* bank width, odd, centered on the estimate */
+#define GOERTZEL_BLOCK 1000    /* samples per block, bin spacing 10 Hz */
+#define GOERTZEL_FS 10000      /* sample rate in Hz, 100 us tick */
+#define GOERTZEL_MIN_MAG 2000  /* peak |X| below this is no signal, unlock */
+
+// Goertzel filter bank tracking the vortex shedding frequency
+struct goertzel_state {
+  int center_q8;              // frequency of the middle bin, Hz in Q.8
+  int coef[GOERTZEL_BINS];    // 2cos(w) per bin, Q2.29
+  int s1[GOERTZEL_BINS];      // filter state, s[n-1]
+  int s2[GOERTZEL_BINS];      // filter state, s[n-2]
+  int samples;                // in the current block
+  int locked;                 // 1 once seeded, 0 after losing the signal
+  int freq_q8;                // last estimate, Hz in Q.8
+  unsigned int mag[GOERTZEL_BINS];  // last block's bin magnitudes, scaled
+};
+
+extern goertzel_state goertzel;
+
+void goertzel_reset(goertzel_state *gs);
+void goertzel_seed(goertzel_state *gs, int freq_q8);
+int goertzel_sample(goertzel_state *gs, unsigned short sample);
+int goertzel_track(goertzel_state *gs, vortex_state *vs, unsigned short sample);
+
+#endif
@@ -37,6 +37,9 @@ using namespace mbed;
 #include "adc.h"
 #include "outputs.h"
 #include "flow_calc.h"
+#include "goertzel.h"
+#include "median.h"
+#include "spectrum.h"
 
 Ticker tick;  //  Creates a timer interrupt using mbed methods
 
@@ -61,6 +64,12 @@ int main()
   lcd_init();
   
   uint32_t count = 0;
+  unsigned short vortex_sample;
+  int new_freq;
+  uint16_t overruns_seen = 0;  // adc_overruns already passed to freq_lost
+  freq_reset(&vortex);
+  goertzel_reset(&goertzel);
+  median_reset(&vortex_median, VORTEX_MEDIAN_WIDTH);
   tick.attach(&timer0, T100US_IN_SECS);
 
   // Cyclical Executive Loop
@@ -71,13 +80,43 @@ int main()
     /****************  ECEN 5003 add code as indicated  ***************/
     uart_poll();  // Polls the serial port
     read_message_from_uart();  // checks for a serial port message received
-    read_all_adcs();  // read ADC channels (if flag set)
-
-    //if( display_flag ) {
-    calc_temp(adc_vals[2]);
-    calc_freq(adc_test_data, VORTEX_INPUT_SIZE);
-    calc_flow(freq, temp);
-    //}
+    if( read_all_adcs() ) {  // read ADC channels (if flag set)
+      // ticks missed while this loop was busy elsewhere still count as
+      // time for the crossing estimate.  The Goertzel and FFT estimators
+      // assume evenly spaced samples and are not corrected.
+      uint16_t overruns = adc_overruns;
+      freq_lost(&vortex, (uint16_t) (overruns - overruns_seen));
+      overruns_seen = overruns;
+      calc_temp(adc_vals[2]);
+#ifdef VORTEX_TEST_DATA
+      vortex_sample = vortex_test_sample();
+#else
+      vortex_sample = adc_vals[1];
+#endif
+#ifdef VORTEX_MEDIAN
+      vortex_sample = median_sample(&vortex_median, vortex_sample);
+#endif
+#ifdef VORTEX_FFT
+      // new frequency and SNR every FFT_SIZE samples
+      new_freq = fft_sample(vortex_sample);
+#else
+#ifdef VORTEX_GOERTZEL
+      // the tracker takes over once seeded from the crossings estimate,
+      // and hands back to it when it loses the signal
+      new_freq = goertzel_track(&goertzel, &vortex, vortex_sample);
+#else
+      // new frequency every VORTEX_INPUT_SIZE samples
+      new_freq = freq_sample(&vortex, vortex_sample);
+#endif
+#endif
+      if( new_freq ) {
+#ifdef VORTEX_FLOW_TABLE
+        flow_lookup(freq_q8, temp);
+#else
+        calc_flow(freq, temp);
+#endif
+      }
+    }
 
     monitor();       // Sends serial port output messages depending
 
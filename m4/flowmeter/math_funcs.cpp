@@ -3,91 +3,28 @@ ECEN5003 - Project 1, Module 4
   math_funcs.cpp
  --------------------------------------------------------*/
 
-const unsigned short pow10_table[] = {
-1220,16588,
-1226,16820,
-1232,17058,
-1238,17301,
-1244,17550,
-1251,17806,
-1257,18068,
-1263,18337,
-1270,18612,
-1276,18894,
-1283,19184,
-1290,19481,
-1296,19786,
-1303,20099,
-1310,20421,
-1317,20751,
-1324,21090,
-1331,21438,
-1338,21796,
-1346,22164,
-1353,22542,
-1360,22931,
-1368,23331,
-1376,23742,
-1383,24166,
-1391,24602,
-1399,25050,
-1407,25513,
-1415,25989,
-1423,26480,
-1431,26985,
-1439,27507,
-1448,28045,
-1456,28600,
-1465,29172,
-1474,29764,
-1483,30374,
-1491,31004,
-1500,31656,
-1510,32329,
-1519,33025,
-1528,33745,
-1538,34490,
-1547,35261,
-1557,36060,
-1567,36886,
-1577,37743,
-1587,38631,
-1597,39552,
-1608,40507,
-1618,41497,
-1629,42526,
-1639,43594,
-1650,44704,
-1661,45858,
-1673,47058,
-1684,48305,
-1696,49604,
-1707,50956,
-1719,52365,
-1731,53833,
-1743,55364,
-1756,56961,
-1768,58628,
-1781,60369,
-1794,62187,
-1807,64089,
-0,0
-};
+#include "math_funcs.h"
 
-// find approximation for 10^x from lookup table
-// num = x*1000
+// approximation for 10^x from pow10_table (pow10_table.cpp)
+// num = x*1000, returns 1000 * 10^x
+// The entry below num is found by index and the next one interpolated
+// linearly, within 0.07% of 10^x; num is clamped to the table.
 int pow10(int num) {
-  int i = 0;
-  int result=0;
-  for(i = 0; pow10_table[i] != 0; i+=2) {
-    if ( pow10_table[i] < num) {
-      result = pow10_table[i+1];
-    }
-  }
-  return result;
+  const int last = (POW10_ENTRIES - 1) << POW10_SHIFT;
+  int offset = num - POW10_X0;
+
+  if( offset <= 0 ) { return pow10_table[0]; }
+  if( offset >= last ) { return pow10_table[POW10_ENTRIES - 1]; }
+  int i = offset >> POW10_SHIFT;
+  int frac = offset & ((1 << POW10_SHIFT) - 1);
+  int step = pow10_table[i+1] - pow10_table[i];
+  return pow10_table[i] + ((step * frac + (1 << (POW10_SHIFT - 1))) >> POW10_SHIFT);
 }
 
 
+// armcc embedded assembler, so host builds (../host_test) get pow10 only
+#ifdef __CC_ARM
+
 // Finds the truncated integer square root of value passed in via r0
 //   r0 : input value / return value
 //   r1 : low search boundary
@@ -101,11 +38,16 @@ __asm int sqrt(unsigned int x)
 	CMP r0, #1   ; make sure we handle the edge case so sqrt(1)=1
 	BLS exit		 ; just return the input if it is 0 or 1
 	
-	MOVS r1, #0  ; low search bound starts at 0
 	MOVS r2, r0  ; use input as high search bound
+	MOVS r1, #1
+	LSLS r1, r1, #16  ; ...but no more than 2^16, so guess^2 fits in 32 bits
+	CMP r2, r1
+	BLS bounded
+	MOVS r2, r1
+bounded
+	MOVS r1, #0  ; low search bound starts at 0
 	
-	PUSH {r3, r4}
-	// store r4-r5 on stack?
+	PUSH {r4, r5}  ; callee-saved, r3 is scratch
 	MOVS r3, #0  ; init guess
 	MOVS r4, r0  ; make last_guess != new_guess
 	
@@ -136,10 +78,11 @@ toohigh
 
 endloop
   MOVS r0, r3  ; return guess
-	POP {r3, r4}
+	POP {r4, r5}
 
 exit
 	BX lr
 
 }
 
+#endif
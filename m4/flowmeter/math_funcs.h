@@ -1,6 +1,15 @@
 #ifndef _math_funcs_h
 #define _math_funcs_h
 
+// 1000 * 10^x at evenly spaced x, generated by host_test/gen_pow10
+// (make pow10_table) into pow10_table.cpp.  The grid covers x =
+// 247.8 / (T_K - 140), the viscosity exponent, for -40..125 C.
+#define POW10_X0 928       /* 1000x of the first entry */
+#define POW10_SHIFT 5      /* 2^5 = 0.032 in x between entries */
+#define POW10_ENTRIES 56   /* x = 0.928 .. 2.688 */
+
+extern const unsigned int pow10_table[POW10_ENTRIES];
+
 int sqrt(unsigned int);
 int pow10(int num);
 
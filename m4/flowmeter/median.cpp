@@ -0,0 +1,70 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  median.cpp
+
+  Spike rejection for the vortex input: a sliding median
+  over 3 to 9 samples, ahead of the frequency path.  A
+  median of w removes any impulse shorter than (w+1)/2
+  samples, which a moving average only spreads out.
+ --------------------------------------------------------*/
+
+#include "median.h"
+
+median_state vortex_median;
+
+// width is rounded down to odd and limited to 3..MEDIAN_MAX
+void median_reset(median_state *ms, int width) {
+  if( width > MEDIAN_MAX ) { width = MEDIAN_MAX; }
+  if( width < 3 ) { width = 3; }
+  ms->width = (unsigned char) (width - !(width & 1));
+  ms->count = 0;
+  ms->head = 0;
+}
+
+// Takes one sample and returns the median of the last width samples (of
+// those seen so far, until width have arrived), delayed (width-1)/2.
+//
+// The sorted copy is updated in place rather than sorted again: a binary
+// search finds the outgoing sample, then the hole it leaves slides toward
+// the new sample's position, moving each entry in between by one.  At most
+// width-1 moves and log2(width) compares, no sort per sample.
+unsigned short median_sample(median_state *ms, unsigned short sample) {
+  unsigned short *s = ms->sorted;
+  int i, lo, hi;
+
+  if( ms->count < ms->width ) {
+    // filling: plain insertion
+    ms->ring[ms->count] = sample;
+    for( i=ms->count; i>0 && s[i-1] > sample; i-- ) {
+      s[i] = s[i-1];
+    }
+    s[i] = sample;
+    ms->count++;
+    return s[(ms->count - 1) >> 1];
+  }
+
+  // find the oldest sample in the sorted copy, any of equal values will do
+  unsigned short out = ms->ring[ms->head];
+  lo = 0;
+  hi = ms->width - 1;
+  while( lo < hi ) {
+    int mid = (lo + hi) >> 1;
+    if( s[mid] < out ) { lo = mid + 1; } else { hi = mid; }
+  }
+  i = lo;
+
+  // slide the hole at i to where sample belongs
+  while( i+1 < ms->width && s[i+1] < sample ) {
+    s[i] = s[i+1];
+    i++;
+  }
+  while( i > 0 && s[i-1] > sample ) {
+    s[i] = s[i-1];
+    i--;
+  }
+  s[i] = sample;
+
+  ms->ring[ms->head] = sample;
+  if( ++ms->head == ms->width ) { ms->head = 0; }
+  return s[ms->width >> 1];
+}
@@ -0,0 +1,25 @@
+#ifndef _median_h
+#define _median_h
+
+#define MEDIAN_MAX 9            /* widest window, odd */
+#define VORTEX_MEDIAN_WIDTH 5   /* odd, 3..MEDIAN_MAX; removes spikes of up to 2 samples */
+
+// A median of w also eats any half cycle shorter than about w samples, so
+// at 10 kHz keep w at or below fs / (4 f) for the highest shedding
+// frequency f: 5 up to about 500 Hz, 3 up to about 1 kHz
+
+// sliding median of the last width samples, kept sorted incrementally
+struct median_state {
+  unsigned short ring[MEDIAN_MAX];    // samples in arrival order
+  unsigned short sorted[MEDIAN_MAX];  // the same samples, ascending
+  unsigned char width;  // window, odd
+  unsigned char count;  // samples held, up to width
+  unsigned char head;   // oldest sample in ring once full
+};
+
+extern median_state vortex_median;
+
+void median_reset(median_state *ms, int width);
+unsigned short median_sample(median_state *ms, unsigned short sample);
+
+#endif
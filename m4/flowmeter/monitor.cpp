@@ -345,6 +345,11 @@ void display_readings() {
   uart_dec_put(convert_temp(adc_vals[2]));
   uart_msg_put("  Freq: ");
   uart_dec_put(freq);
+  // crossing detector's view of the vortex signal, adc counts
+  uart_msg_put("  Offset: ");
+  uart_dec_put(vortex_offset(&vortex));
+  uart_msg_put("  Amplitude: ");
+  uart_dec_put(vortex_amplitude(&vortex));
 }
 
 
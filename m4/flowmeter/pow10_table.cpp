@@ -0,0 +1,19 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  pow10_table.cpp
+
+  Generated by host_test/gen_pow10, do not edit.
+  1000 * 10^x for x = 0.928 to 2.688 in steps of 0.032.
+ --------------------------------------------------------*/
+
+#include "math_funcs.h"
+
+const unsigned int pow10_table[POW10_ENTRIES] = {
+    8472,   9120,   9817,  10568,  11376,  12246,  13183,  14191,
+   15276,  16444,  17701,  19055,  20512,  22080,  23768,  25586,
+   27542,  29648,  31915,  34356,  36983,  39811,  42855,  46132,
+   49659,  53456,  57544,  61944,  66681,  71779,  77268,  83176,
+   89536,  96383, 103753, 111686, 120226, 129420, 139316, 149968,
+  161436, 173780, 187068, 201372, 216770, 233346, 251189, 270396,
+  291072, 313329, 337287, 363078, 390841, 420727, 452898, 487528,
+};
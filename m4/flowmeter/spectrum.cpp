@@ -0,0 +1,260 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  spectrum.cpp
+
+  Spectral vortex frequency: Hann-windowed real FFT of a
+  block of samples, strongest non-DC bin as in plot_data.m,
+  refined by interpolating with its larger neighbour.
+  Everything happens in one q15 buffer of FFT_SIZE, 2 KB.
+ --------------------------------------------------------*/
+
+#include "spectrum.h"
+#include "flow_calc.h"   // freq, freq_q8
+#include "sqrt_funcs.h"
+#include "const_seq.h"
+
+short fft_buf[FFT_SIZE];
+int freq_snr_db = 0;
+
+//******************************************************************************
+// cos(2 pi i / FFT_SIZE) for i = 0..FFT_SIZE/4 in q15, built at compile time.
+// Serves the Hann window, the FFT twiddles and the real FFT split step.
+//******************************************************************************
+
+// cos(x) for x in [0, pi/2], Taylor series to x^22 in Horner form, in
+// double for constexpr: 1 - x^2/(1*2) (1 - x^2/(3*4) (1 - ...))
+constexpr double cos_taylor_from(double x2, int k) {
+  return (k >= 12) ? 1 : 1 - x2 / ((2*k - 1) * (2*k)) * cos_taylor_from(x2, k + 1);
+}
+
+constexpr double cos_taylor(double x) {
+  return cos_taylor_from(x * x, 1);
+}
+
+constexpr short cos_entry(unsigned i) {
+  return (short) (32767 * cos_taylor(2 * 3.14159265358979323846 * i / FFT_SIZE) + 0.5);
+}
+
+template<class Seq> struct cos_quarter;
+
+template<unsigned... I>
+struct cos_quarter<index_seq<I...> > {
+  static constexpr short v[sizeof...(I)] = { cos_entry(I)... };
+};
+
+template<unsigned... I>
+constexpr short cos_quarter<index_seq<I...> >::v[sizeof...(I)];
+
+typedef cos_quarter<make_index_seq<FFT_SIZE/4 + 1>::type> cos_table;
+static_assert(cos_table::v[0] == 32767 && cos_table::v[FFT_SIZE/4] == 0,
+              "cos table endpoints");
+
+// cos(2 pi i / FFT_SIZE) for 0 <= i <= FFT_SIZE/2, q15
+static short cos_n(int i) {
+  if( i <= FFT_SIZE/4 ) { return cos_table::v[i]; }
+  return -cos_table::v[FFT_SIZE/2 - i];
+}
+
+// |X[k]|^2 of a re, im interleaved spectrum
+static unsigned int bin_power(const short *bins, int k) {
+  int re = bins[2*k], im = bins[2*k+1];
+  return (unsigned int) (re * re) + (unsigned int) (im * im);
+}
+
+// cos(2 pi phase / 2^16), q15, interpolated between table entries
+static int cos_turn(unsigned int phase) {
+  const int shift = 16 - FFT_LOG2;
+  int i = (phase & 0xffff) >> shift;
+  int frac = phase & ((1 << shift) - 1);
+  int c0, c1;
+
+  // cos is even and cos(x + pi) = -cos(x)
+  if( i >= FFT_SIZE/2 ) { i = FFT_SIZE - i - 1; frac = (1 << shift) - frac; }
+  c0 = cos_n(i);
+  c1 = (i + 1 < FFT_SIZE/2) ? cos_n(i + 1) : -32767;
+  return c0 + (((c1 - c0) * frac) >> shift);
+}
+
+// sin(2 pi i / FFT_SIZE) for 0 <= i <= FFT_SIZE/2, q15
+static short sin_n(int i) {
+  if( i <= FFT_SIZE/4 ) { return cos_table::v[FFT_SIZE/4 - i]; }
+  return cos_table::v[i - FFT_SIZE/4];
+}
+
+// Block floating point: halves the buffer until no value can overflow q15
+// in the next radix-2 stage, |a +/- w*b| <= (1 + sqrt 2) * max, i.e. until
+// max < 13573.  One halving is not enough above 27146.  Returns the number
+// of halvings (0 to 2).
+static int fft_guard(short *buf, int n) {
+  int max = 0, shift = 0;
+  for( int i=0; i<n; i++ ) {
+    int v = (buf[i] < 0) ? -buf[i] : buf[i];
+    if( v > max ) { max = v; }
+  }
+  while( (max >> shift) >= 13573 ) { shift++; }
+  if( shift ) {
+    for( int i=0; i<n; i++ ) { buf[i] >>= shift; }
+  }
+  return shift;
+}
+
+// In-place real FFT of FFT_SIZE q15 samples, as an FFT_SIZE/2 point
+// complex FFT of the even/odd samples (radix-2, decimation in time)
+// followed by the split step.  Output is bins 0..FFT_SIZE/2-1 as re, im
+// pairs, with the real Nyquist bin in place of bin 0's imaginary part.
+// Spectrum = output * 2^(returned exponent).
+//
+// Not CMSIS-DSP's arm_rfft_q15: this mbed build ships arm_math.h but its
+// mbed.ar has none of the DSP objects, and arm_rfft_q15 would need a
+// separate 2*FFT_SIZE q15 output (another 4 KB of the 16 KB of RAM).
+int rfft_q15(short *buf) {
+  const int m = FFT_SIZE / 2;  // complex points
+  int exponent = 0;
+
+  // bit reversal of the complex points
+  for( int i=1, j=0; i<m; i++ ) {
+    int bit = m >> 1;
+    for( ; j & bit; bit >>= 1 ) { j ^= bit; }
+    j |= bit;
+    if( i < j ) {
+      short t;
+      t = buf[2*i];   buf[2*i] = buf[2*j];     buf[2*j] = t;
+      t = buf[2*i+1]; buf[2*i+1] = buf[2*j+1]; buf[2*j+1] = t;
+    }
+  }
+
+  // butterflies, twiddle w = exp(-2 pi i k / len) = table index k*N/len
+  for( int len=2; len<=m; len<<=1 ) {
+    int step = FFT_SIZE / len;
+    exponent += fft_guard(buf, FFT_SIZE);
+    for( int start=0; start<m; start+=len ) {
+      for( int k=0; k<len/2; k++ ) {
+        int wr = cos_n(k * step), wi = -sin_n(k * step);
+        short *a = &buf[2*(start + k)];
+        short *b = &buf[2*(start + k + len/2)];
+        int tr = (b[0] * wr - b[1] * wi) >> 15;
+        int ti = (b[0] * wi + b[1] * wr) >> 15;
+        b[0] = a[0] - tr;  b[1] = a[1] - ti;
+        a[0] = a[0] + tr;  a[1] = a[1] + ti;
+      }
+    }
+  }
+
+  // split: X[k] = E + W^k O, X[m-k] = conj(E - W^k O), where
+  // E = (Z[k] + conj Z[m-k]) / 2, O = -i (Z[k] - conj Z[m-k]) / 2
+  exponent += fft_guard(buf, FFT_SIZE);
+  int z0r = buf[0], z0i = buf[1];
+  buf[0] = z0r + z0i;  // DC
+  buf[1] = z0r - z0i;  // Nyquist
+  for( int k=1; k<=m/2; k++ ) {
+    short *a = &buf[2*k], *b = &buf[2*(m - k)];
+    int er = (a[0] + b[0]) >> 1, ei = (a[1] - b[1]) >> 1;
+    int or_ = (a[1] + b[1]) >> 1, oi = (b[0] - a[0]) >> 1;
+    int wr = cos_n(k), wi = -sin_n(k);
+    int tr = (or_ * wr - oi * wi) >> 15;
+    int ti = (or_ * wi + oi * wr) >> 15;
+    a[0] = er + tr;  a[1] = ei + ti;
+    if( k < m - k ) {
+      b[0] = er - tr;  b[1] = -(ei - ti);
+    }
+  }
+  return exponent;
+}
+
+// floor(log2(x)) in Q8, fraction linear in the mantissa, for the SNR
+static int log2_q8(unsigned long long x) {
+  int e = 0;
+  if( x == 0 ) { return 0; }
+  while( x >> (e + 1) ) { e++; }
+  unsigned int frac = (e >= 8) ? (unsigned int) (x >> (e - 8)) & 0xff
+                               : (unsigned int) (x << (8 - e)) & 0xff;
+  return (e << 8) + frac;
+}
+
+// Spectral frequency of sample_count samples (up to FFT_SIZE, zero
+// padded), published to freq, freq_q8 and freq_snr_db like calc_freq.
+//
+// The block is centered, Hann windowed over the samples present and
+// transformed in place.  The strongest bin from 2 up (bin 1 holds the
+// window's DC leakage) is refined with its larger neighbour: for a Hann
+// window a tone d bins above bin k gives |X[k+1]| / |X[k]| = (1+d)/(2-d),
+// so d = (2|X[k+1]| - |X[k]|) / (|X[k]| + |X[k+1]|), with no log or
+// divide per bin.  SNR is the power within 3 bins of the peak (the main
+// lobe and first sidelobe) against the rest of the spectrum above DC.
+int calc_freq_fft(unsigned short *vals, int sample_count) {
+  const int half = FFT_SIZE / 2;
+  int n = (sample_count < FFT_SIZE) ? sample_count : FFT_SIZE;
+  unsigned int power, peak_power = 0;
+  int peak = 2;
+
+  // Hann window phase i/n turn, stepped in 1/2^32 turn, one divide
+  unsigned int phase = 0;
+  unsigned int phase_step = (unsigned int) ((1ULL << 32) / (n ? n : 1));
+
+  for( int i=0; i<FFT_SIZE; i++ ) {
+    if( i < n ) {
+      // Hann: (1 - cos(2 pi i / n)) / 2
+      int w = (32767 - cos_turn(phase >> 16)) >> 1;
+      phase += phase_step;
+      fft_buf[i] = (short) ((((int) vals[i] - 0x8000) * w) >> 15);
+    } else {
+      fft_buf[i] = 0;
+    }
+  }
+
+  rfft_q15(fft_buf);
+
+  // strongest bin, total power above DC
+  unsigned long long total = 0, lobe = 0;
+  for( int k=2; k<half; k++ ) {
+    power = bin_power(fft_buf, k);
+    total += power;
+    if( power > peak_power ) {
+      peak_power = power;
+      peak = k;
+    }
+  }
+  for( int k=peak-3; k<=peak+3; k++ ) {
+    if( k >= 2 && k < half ) {
+      lobe += bin_power(fft_buf, k);
+    }
+  }
+  if( total == lobe ) {
+    freq_snr_db = 99;  // nothing outside the peak at this resolution
+  } else {
+    // 10 log10(x) = 3.0103 log2(x), 3.0103 ~= 771/256
+    freq_snr_db = ((log2_q8(lobe) - log2_q8(total - lobe)) * 771) >> 16;
+  }
+
+  // interpolate toward the larger neighbour
+  int f_bin_q8 = peak << 8;
+  if( peak_power > 0 && peak + 1 < half ) {
+    unsigned int m_k = sqrt_clz(peak_power);
+    unsigned int m_lo = sqrt_clz(bin_power(fft_buf, peak-1));
+    unsigned int m_hi = sqrt_clz(bin_power(fft_buf, peak+1));
+    unsigned int m_nb = (m_hi > m_lo) ? m_hi : m_lo;
+    int d_q8 = ((2 * (int) m_nb - (int) m_k) * 256) / (int) (m_k + m_nb);
+    if( d_q8 < 0 ) { d_q8 = 0; }
+    f_bin_q8 += (m_hi > m_lo) ? d_q8 : -d_q8;
+  }
+
+  // bin spacing FFT_FS / FFT_SIZE
+  freq_q8 = (f_bin_q8 * (FFT_FS >> 4)) >> (FFT_LOG2 - 4);
+  freq = (freq_q8 + 128) >> 8;
+  return freq;
+}
+
+// Streaming form: collects one sample per 100 us tick straight into
+// fft_buf and runs calc_freq_fft on it once FFT_SIZE have arrived.
+// Returns 1 when freq was updated.  The transform takes a few ms, samples
+// arriving meanwhile are missed and the next block starts after it.
+int fft_sample(unsigned short sample) {
+  static int count = 0;
+  unsigned short *block = (unsigned short *) fft_buf;
+
+  block[count] = sample;
+  if( ++count < FFT_SIZE ) { return 0; }
+  count = 0;
+  calc_freq_fft(block, FFT_SIZE);
+  return 1;
+}
@@ -0,0 +1,15 @@
+#ifndef _spectrum_h
+#define _spectrum_h
+
+#define FFT_LOG2 10
+#define FFT_SIZE (1 << FFT_LOG2)  /* real samples per block, 102.4 ms */
+#define FFT_FS 10000              /* sample rate in Hz, 100 us tick */
+
+extern short fft_buf[FFT_SIZE];  // samples in, spectrum out, in place
+extern int freq_snr_db;          // SNR of the last spectral peak, dB
+
+int calc_freq_fft(unsigned short *vals, int sample_count);
+int fft_sample(unsigned short sample);
+int rfft_q15(short *buf);  // in-place real FFT, returns the block exponent
+
+#endif
@@ -0,0 +1,288 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  sqrt_funcs.cpp
+
+  Integer square roots for the Cortex-M0+, which has no
+  hardware divider and no CLZ instruction.  Plain C++ so
+  the same source builds on the host for verification
+  (see ../host_test).
+ --------------------------------------------------------*/
+
+#include "sqrt_funcs.h"
+#include "const_seq.h"
+
+//******************************************************************************
+// Compile-time seed tables
+//
+// Generated by constexpr code rather than pasted in, so the table size can be
+// traded against cycles per build (SQRT_SEED_BITS, RSQRT_SEED_BITS in
+// sqrt_funcs.h).  Each table is a constant-initialized const object, which
+// the linker places in flash, and every entry is checked by a static_assert
+// against the defining inequality, independently of how it was generated.
+// C++11 constexpr only (single-return functions, recursion instead of
+// loops), so armcc builds it as well as gcc and armclang.
+//******************************************************************************
+
+// floor(sqrt(n)), digit-by-digit, one recursion per root bit
+constexpr unsigned long long isqrt64_step(unsigned long long n, unsigned long long rem,
+                                          unsigned long long root, int i);
+
+constexpr unsigned long long isqrt64_bit(unsigned long long n, unsigned long long rem,
+                                         unsigned long long root, int i) {
+  return (rem >= 2*root + 1) ? isqrt64_step(n, rem - (2*root + 1), root | 1, i + 1)
+                             : isqrt64_step(n, rem, root, i + 1);
+}
+
+constexpr unsigned long long isqrt64_step(unsigned long long n, unsigned long long rem,
+                                          unsigned long long root, int i) {
+  return (i == 32) ? root : isqrt64_bit(n << 2, (rem << 2) | (n >> 62), root << 1, i);
+}
+
+constexpr unsigned long long isqrt64(unsigned long long n) {
+  return isqrt64_step(n, 0, 0, 0);
+}
+
+// round(sqrt(a/b)) = floor((sqrt(4a/b) + 1) / 2), exact in integers
+constexpr unsigned long long round_sqrt_ratio(unsigned long long a, unsigned long long b) {
+  return (isqrt64(4*a / b) + 1) >> 1;
+}
+
+// v == round(sqrt(a/b))  <=>  (2v-1)^2 * b <= 4a < (2v+1)^2 * b
+constexpr bool is_round_sqrt_ratio(unsigned long long v, unsigned long long a, unsigned long long b) {
+  return (v == 0 || (2*v-1)*(2*v-1)*b <= 4*a) && 4*a < (2*v+1)*(2*v+1)*b;
+}
+
+// Seed table for sqrt_clz: round(sqrt(k * 2^(32-BITS))) - 2^15 for
+// k = 2^(BITS-2) .. 2^BITS.  Covers a normalized input m in [2^30, 2^32),
+// indexed by its top BITS bits, with one extra entry to interpolate to.
+// BITS=7 is 97 halfwords (194 bytes) of flash.
+template<unsigned BITS>
+struct sqrt_seed_def {
+  static constexpr unsigned size = sqrt_seed_entries(BITS);
+  static constexpr unsigned long long k0 = 1ULL << (BITS-2);
+
+  static constexpr unsigned short entry(unsigned i) {
+    return (unsigned short) (round_sqrt_ratio((k0 + i) << (32-BITS), 1) - 0x8000);
+  }
+  static constexpr bool ok(unsigned i, unsigned short v) {
+    return is_round_sqrt_ratio(v + 0x8000ULL, (k0 + i) << (32-BITS), 1);
+  }
+};
+
+// Seed table for rsqrt_q31: 2^14 / sqrt((i + 2^(BITS-2) + 1/2) / 2^BITS) in
+// Q2.14, i.e. round(sqrt(2^(29+BITS) / (2i + 2^(BITS-1) + 1))).  Midpoints of
+// the intervals of a normalized input m/2^32 in [1/4, 1), indexed by the top
+// BITS bits of m.  Seed error is below 2^-BITS (1.6% for BITS=6).
+template<unsigned BITS>
+struct rsqrt_seed_def {
+  static constexpr unsigned size = rsqrt_seed_entries(BITS);
+
+  static constexpr unsigned short entry(unsigned i) {
+    return (unsigned short) round_sqrt_ratio(1ULL << (29+BITS), 2*i + (1ULL << (BITS-1)) + 1);
+  }
+  static constexpr bool ok(unsigned i, unsigned short v) {
+    return is_round_sqrt_ratio(v, 1ULL << (29+BITS), 2*i + (1ULL << (BITS-1)) + 1);
+  }
+};
+
+// The table of a definition above, Def::entry(i) for i < Def::size, and
+// its check over entries lo..hi-1, halving so recursion depth is log2(size)
+template<class Def, class Seq = typename make_index_seq<Def::size>::type>
+struct seed_table;
+
+template<class Def, unsigned... I>
+struct seed_table<Def, index_seq<I...> > {
+  static constexpr unsigned short v[sizeof...(I)] = { Def::entry(I)... };
+
+  static constexpr bool check(unsigned lo = 0, unsigned hi = sizeof...(I)) {
+    return (hi - lo == 1) ? Def::ok(lo, v[lo])
+                          : check(lo, (lo + hi) / 2) && check((lo + hi) / 2, hi);
+  }
+};
+
+template<class Def, unsigned... I>
+constexpr unsigned short seed_table<Def, index_seq<I...> >::v[sizeof...(I)];
+
+// Correction steps sqrt_clz<BITS> needs after interpolating.  Every table
+// entry is rounded, so the estimate is at most 1 high.  The interpolation
+// chord lies below the concave sqrt curve by at most 2^(14-2*BITS) (root of
+// the normalized input in [2^15, 2^16]), so the estimate is up to that plus
+// one low.
+constexpr unsigned sqrt_up_steps(unsigned bits) {
+  return ((1U << 14) >> (2*bits)) + (((1U << 14) & ((1U << (2*bits)) - 1)) != 0) + 1;
+}
+
+// Truncated integer square root, seeded from the sqrt_seed_def<BITS> table.
+//
+//  1. software CLZ: shift the input left by an even amount until one of its
+//     top two bits is set (4 compare/shift steps)
+//  2. linear interpolation between two table entries using the next 16 bits
+//     gives the root of the normalized input to within -2..+1 (BITS=7)
+//  3. undo the normalization with a right shift, then at most one decrement
+//     and sqrt_up_steps(BITS) increments (2 for BITS >= 7), tracking the
+//     remainder so only one MULS is needed
+//
+// Fixed cost of roughly 50 cycles on the M0+ with BITS=7, against ~12 cycles
+// per pass for the bisection sqrt() in math_funcs.cpp, which needs ~20 passes
+// in the Re range 10^5 - 10^7.  Proven equal to sqrt_trunc for all 2^32
+// inputs by the host build.
+template<unsigned BITS>
+unsigned int sqrt_clz_t(unsigned int num) {
+  static_assert(BITS >= 5 && BITS <= 12, "sqrt seed table must index 5 to 12 bits");
+  typedef seed_table<sqrt_seed_def<BITS> > table;
+  static_assert(table::check(), "sqrt seed table entry is not round(sqrt(k))");
+
+  unsigned int m = num;
+  unsigned int shift = 0;
+  unsigned int idx, frac, root, rem, step;
+  const unsigned short *seed;
+
+  if( num <= 1 ) { return num; }
+
+  // normalize so m is in [2^30, 2^32)
+  if( m < 0x00010000 ) { m <<= 16; shift += 16; }
+  if( m < 0x01000000 ) { m <<= 8;  shift += 8;  }
+  if( m < 0x10000000 ) { m <<= 4;  shift += 4;  }
+  if( m < 0x40000000 ) { m <<= 2;  shift += 2;  }
+
+  // interpolate the root of m, in [2^15, 2^16]
+  idx = (m >> (32-BITS)) - (1U << (BITS-2));
+  frac = (m >> (16-BITS)) & 0xffff;
+  seed = &table::v[idx];
+  root = 0x8000 + seed[0] + (((seed[1] - seed[0]) * frac) >> 16);
+
+  // root of num, then correct the estimate
+  root >>= shift >> 1;
+  if( root > 0xffff ) { root = 0xffff; }  // keep root*root in 32 bits
+
+  rem = root * root;
+  if( rem > num ) {
+    root--;
+    rem -= 2*root + 1;
+  }
+  rem = num - rem;
+  step = 2*root + 1;  // (root+1)^2 - root^2
+  for( unsigned i=0; i<sqrt_up_steps(BITS); i++ ) {
+    if( rem < step ) { break; }
+    rem -= step;
+    root++;
+    step += 2;
+  }
+  return root;
+}
+
+unsigned int sqrt_clz(unsigned int num) {
+  return sqrt_clz_t<SQRT_SEED_BITS>(num);
+}
+
+// Reciprocal square root, 1/sqrt(num), returned in Q1.31.
+//
+// Normalizes num to m in [2^30, 2^32) by an even shift, seeds
+// y ~ 1/sqrt(m/2^32) from the rsqrt_seed_def<BITS> table, then runs Newton
+// steps y = y*(3 - m*y^2)/2 in Q2.30.  Only multiplies and shifts, no
+// divide.  The seed error e becomes 1.5e^2 per step; with BITS=6 two steps
+// take 1.6% -> 4e-4 -> 2e-7, under the output quantization of the Q1.31
+// result for any num above ~10^3.
+//
+// The result is shifted back down by 15 - shift/2 bits, so for larger inputs
+// the absolute resolution stays 2^-31 and the relative error grows as
+// sqrt(num) * 2^-31.  Error against double precision, from the host sweep:
+//   num <= 10^7 (all Reynolds numbers of interest): < 2e-6 relative
+//   num up to 2^32:                                 < 4e-5 relative
+// rsqrt_q31(0) saturates to 0xffffffff.
+template<unsigned BITS>
+unsigned int rsqrt_q31_t(unsigned int num) {
+  static_assert(BITS >= 4 && BITS <= 12, "rsqrt seed table must index 4 to 12 bits");
+  typedef seed_table<rsqrt_seed_def<BITS> > table;
+  static_assert(table::check(), "rsqrt seed table entry is not round(2^14/sqrt(x))");
+
+  unsigned int m = num;
+  unsigned int shift = 0;
+  unsigned long long y, my2;
+
+  if( num == 0 ) { return 0xffffffff; }
+
+  // normalize so m is in [2^30, 2^32)
+  if( m < 0x00010000 ) { m <<= 16; shift += 16; }
+  if( m < 0x01000000 ) { m <<= 8;  shift += 8;  }
+  if( m < 0x10000000 ) { m <<= 4;  shift += 4;  }
+  if( m < 0x40000000 ) { m <<= 2;  shift += 2;  }
+
+  // seed, Q2.14 -> Q2.30
+  y = (unsigned long long) table::v[(m >> (32-BITS)) - (1U << (BITS-2))] << 16;
+
+  for( unsigned i=0; i<rsqrt_newton_steps(BITS); i++ ) {
+    my2 = (((y * y) >> 30) * m) >> 32;   // m*y^2, ~1.0 in Q2.30
+    y = (y * ((3ULL << 30) - my2)) >> 31; // y*(3 - m*y^2)/2
+  }
+
+  // 1/sqrt(num) = y * 2^(shift/2 - 16), Q2.30 -> Q1.31
+  y >>= 15 - (shift >> 1);
+  return (y > 0xffffffff) ? 0xffffffff : (unsigned int) y;
+}
+
+unsigned int rsqrt_q31(unsigned int num) {
+  return rsqrt_q31_t<RSQRT_SEED_BITS>(num);
+}
+
+// Every table size sqrt_funcs.h offers, so other modules link against
+// this file rather than needing the definitions.  The linker drops the
+// ones nothing calls, tables included.
+template unsigned int sqrt_clz_t<5>(unsigned int);
+template unsigned int sqrt_clz_t<6>(unsigned int);
+template unsigned int sqrt_clz_t<7>(unsigned int);
+template unsigned int sqrt_clz_t<8>(unsigned int);
+template unsigned int sqrt_clz_t<9>(unsigned int);
+template unsigned int sqrt_clz_t<10>(unsigned int);
+template unsigned int sqrt_clz_t<11>(unsigned int);
+template unsigned int sqrt_clz_t<12>(unsigned int);
+template unsigned int rsqrt_q31_t<4>(unsigned int);
+template unsigned int rsqrt_q31_t<5>(unsigned int);
+template unsigned int rsqrt_q31_t<6>(unsigned int);
+template unsigned int rsqrt_q31_t<7>(unsigned int);
+template unsigned int rsqrt_q31_t<8>(unsigned int);
+template unsigned int rsqrt_q31_t<9>(unsigned int);
+template unsigned int rsqrt_q31_t<10>(unsigned int);
+template unsigned int rsqrt_q31_t<11>(unsigned int);
+template unsigned int rsqrt_q31_t<12>(unsigned int);
+
+// Square root of a Q16.16 value, returned in Q16.16 and truncated, so
+// sqrt_q16(x) = floor(sqrt(x * 2^16)), at most 1 LSB (2^-16) below the
+// exact root.  Inputs below 1.0 keep their full precision, unlike
+// truncating to an integer before calling sqrt.
+//
+// Normalizes x to m in [2^30, 2^32) by an even shift s (exact), takes the
+// top 16 bits of the root with sqrt_clz(m), then 8 more digit-by-digit
+// passes with zero input bits give R = floor(sqrt(m * 2^16)), a 24-bit root.
+// Since floor(floor(y)/2^k) = floor(y/2^k), R >> s/2 is the truncated root
+// of x * 2^16.  One MULS and 8 fixed passes of shifts and compares after
+// sqrt_clz, no divide.
+unsigned int sqrt_q16(unsigned int q16) {
+  unsigned int m = q16;
+  unsigned int shift = 0;
+  unsigned int root, rem, trial, bit;
+
+  if( q16 == 0 ) { return 0; }
+
+  // normalize so m is in [2^30, 2^32)
+  if( m < 0x00010000 ) { m <<= 16; shift += 16; }
+  if( m < 0x01000000 ) { m <<= 8;  shift += 8;  }
+  if( m < 0x10000000 ) { m <<= 4;  shift += 4;  }
+  if( m < 0x40000000 ) { m <<= 2;  shift += 2;  }
+
+  // integer part of the root of m, remainder at most 2*root < 2^17
+  root = sqrt_clz(m);
+  rem = m - root * root;
+
+  // 8 more result bits, each from the next two (zero) input bits.  The
+  // remainder stays at most 2*root < 2^25, so rem << 2 fits in 32 bits.
+  for( int i=0; i<8; i++ ) {
+    rem <<= 2;
+    trial = (root << 2) | 1;  // (2*root+1)^2 - (2*root)^2
+    bit = (rem >= trial);
+    rem -= trial & -bit;  // branch-free, nothing for the host to mispredict
+    root = (root << 1) | bit;
+  }
+
+  return root >> (shift >> 1);
+}
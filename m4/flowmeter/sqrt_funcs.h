@@ -0,0 +1,40 @@
+#ifndef _sqrt_funcs_h
+#define _sqrt_funcs_h
+
+// Seed table sizes, as index bits of the normalized input.  The sqrt table
+// is 3*2^(BITS-2)+1 halfwords, the rsqrt table 3*2^(BITS-2).
+#ifndef SQRT_SEED_BITS
+#define SQRT_SEED_BITS 7
+#endif
+#ifndef RSQRT_SEED_BITS
+#define RSQRT_SEED_BITS 6
+#endif
+
+constexpr unsigned sqrt_seed_entries(unsigned bits) {
+  return (3U << (bits-2)) + 1;
+}
+
+constexpr unsigned rsqrt_seed_entries(unsigned bits) {
+  return 3U << (bits-2);
+}
+
+// Newton steps rsqrt_q31 runs after a seed of the given bits: the seed
+// error 2^-bits becomes 1.5e^2 per step, iterate until it is below 2^-22.
+constexpr unsigned newton_steps_from(double e) {
+  return (e < 1.0 / (1ULL << 22)) ? 0 : 1 + newton_steps_from(1.5 * e * e);
+}
+
+constexpr unsigned rsqrt_newton_steps(unsigned bits) {
+  return newton_steps_from(1.0 / (1ULL << bits));
+}
+
+unsigned int sqrt_clz(unsigned int num);
+unsigned int rsqrt_q31(unsigned int num);  /* 1/sqrt(num) in Q1.31 */
+unsigned int sqrt_q16(unsigned int q16);   /* Q16.16 in and out */
+
+// Same kernels with an explicit table size (sqrt: 5..12, rsqrt: 4..12),
+// each instantiated in sqrt_funcs.cpp
+template<unsigned BITS> unsigned int sqrt_clz_t(unsigned int num);
+template<unsigned BITS> unsigned int rsqrt_q31_t(unsigned int num);
+
+#endif
@@ -65,6 +65,7 @@
 */
 
 #include "timer.h"
+#include "flow_calc.h"  // VORTEX_CIC
 
 /*********************/
 /*   Definitions     */
@@ -73,7 +74,8 @@
 UCHAR display_timer = 0;  // 1 second software timer for display
 UCHAR display_flag = 0;   // flag between timer interrupt and monitor
 
-UCHAR adc_flag = 0;  // 100us per ADC read
+volatile UCHAR adc_flag = 0;  // 100us per ADC read
+volatile uint16_t adc_overruns = 0;  // samples main missed, wraps
 
 UCHAR red_heartbeat_timer = 0;
 volatile UCHAR red_heartbeat_flag = 0;
@@ -111,6 +113,13 @@ void timer0(void)
 
   //    B.   Update Sensors
   /****************  ECEN 5003 add code as indicated *****************/
+#ifndef VORTEX_CIC
+  // main has not taken the last tick's sample: that one is lost.  With
+  // the CIC, adc_cic_isr counts its own overruns instead.
+  if( adc_flag ) {
+    adc_overruns++;
+  }
+#endif
   adc_flag = 1;   // time to sample the ADC in main
 
   /*******************************************************************/
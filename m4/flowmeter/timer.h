@@ -25,8 +25,10 @@ extern volatile UCHAR red_heartbeat_flag; /* flag set when heartbeat should togg
 extern UCHAR display_timer;  // 1.6 seconds when reset to 0
 extern UCHAR display_flag;   // set when timer expires, cleared by monitor after output
 
-extern UCHAR  adc_flag;  // flag which times ADC sampling using the timer
-                         // interrupt semaphore to main
+extern volatile UCHAR adc_flag;  // flag which times ADC sampling using the timer
+                                 // interrupt semaphore to main
+extern volatile uint16_t adc_overruns;  // ticks that found adc_flag still set,
+                                        // written only by the interrupts
 void timer0(void);
 
 #endif
@@ -0,0 +1,54 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  water_table.cpp
+
+  Generated by host_test/gen_water_table, do not edit.
+  Density in kg/m^3 (Q10.6) and viscosity in mPa s
+  (Q16.16) of water, one entry per C from -40 C.
+ --------------------------------------------------------*/
+
+#include "water_table.h"
+
+const unsigned short water_density[WATER_TABLE_ROWS] = {
+  61847, 62006, 62154, 62290, 62417, 62535, 62645, 62747, 62842, 62931,
+  63014, 63091, 63163, 63231, 63294, 63353, 63409, 63460, 63509, 63554,
+  63596, 63635, 63671, 63705, 63737, 63766, 63793, 63818, 63841, 63863,
+  63882, 63900, 63916, 63930, 63943, 63954, 63964, 63973, 63980, 63987,
+  63992, 63995, 63998, 63999, 64000, 63999, 63998, 63996, 63992, 63988,
+  63983, 63977, 63970, 63962, 63953, 63944, 63934, 63923, 63912, 63900,
+  63887, 63873, 63859, 63844, 63829, 63813, 63796, 63779, 63761, 63742,
+  63723, 63704, 63684, 63663, 63642, 63620, 63598, 63575, 63552, 63528,
+  63504, 63479, 63454, 63428, 63402, 63376, 63349, 63321, 63293, 63265,
+  63236, 63207, 63177, 63147, 63117, 63086, 63055, 63023, 62991, 62958,
+  62925, 62892, 62859, 62825, 62790, 62755, 62720, 62685, 62649, 62613,
+  62576, 62539, 62502, 62464, 62426, 62387, 62349, 62310, 62270, 62230,
+  62190, 62150, 62109, 62068, 62026, 61984, 61942, 61900, 61857, 61814,
+  61770, 61727, 61683, 61638, 61593, 61548, 61503, 61457, 61411, 61365,
+  61318, 61271, 61224, 61176, 61128, 61080, 61032, 60983, 60934, 60884,
+  60835, 60785, 60734, 60684, 60633, 60582, 60530, 60478, 60426, 60374,
+  60321, 60268, 60215, 60161, 60107, 60053,
+};
+
+const unsigned int water_viscosity[WATER_TABLE_ROWS] = {
+   719311,  674002,  632412,  594175,  558967,  526500,  496518,  468792,
+   443117,  419310,  397208,  376662,  357540,  339722,  323100,  307577,
+   293063,  279480,  266754,  254819,  243615,  233088,  223186,  213865,
+   205082,  196800,  188983,  181599,  174618,  168014,  161760,  155835,
+   150216,  144884,  139820,  135009,  130434,  126081,  121936,  117987,
+   114222,  110631,  107204,  103930,  100803,   97812,   94952,   92214,
+    89592,   87080,   84673,   82363,   80148,   78021,   75978,   74015,
+    72128,   70314,   68568,   66888,   65270,   63711,   62209,   60761,
+    59365,   58017,   56717,   55461,   54249,   53077,   51944,   50849,
+    49790,   48766,   47774,   46814,   45884,   44983,   44111,   43265,
+    42444,   41649,   40877,   40128,   39401,   38695,   38009,   37343,
+    36696,   36067,   35455,   34860,   34282,   33719,   33171,   32638,
+    32119,   31614,   31121,   30641,   30174,   29718,   29274,   28841,
+    28419,   28007,   27604,   27212,   26829,   26455,   26090,   25734,
+    25386,   25045,   24713,   24388,   24071,   23760,   23457,   23160,
+    22869,   22585,   22307,   22035,   21769,   21508,   21253,   21003,
+    20759,   20519,   20284,   20054,   19829,   19608,   19391,   19179,
+    18971,   18766,   18566,   18370,   18177,   17988,   17803,   17621,
+    17442,   17267,   17095,   16926,   16760,   16597,   16437,   16279,
+    16125,   15973,   15824,   15678,   15534,   15392,   15253,   15116,
+    14982,   14849,   14719,   14591,   14465,   14342,
+};
@@ -0,0 +1,13 @@
+#ifndef _water_table_h
+#define _water_table_h
+
+// Density and viscosity of water by whole degree C, sampled from the
+// formulas calc_flow_float uses by host_test/gen_water_table (make
+// water_table), for calc_flow.  Index with temp - WATER_TABLE_TMIN.
+#define WATER_TABLE_TMIN (-40)   /* first entry, C */
+#define WATER_TABLE_ROWS 166     /* -40 .. 125 C */
+
+extern const unsigned short water_density[WATER_TABLE_ROWS];  /* kg/m^3, Q10.6 */
+extern const unsigned int water_viscosity[WATER_TABLE_ROWS];   /* mPa s, Q16.16 */
+
+#endif
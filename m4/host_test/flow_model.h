@@ -0,0 +1,51 @@
+// The flow model of m4/plot_data.m in double precision: viscosity and
+// density of water from the temperature, then the velocity that makes
+// v = f d / St(Re(v)) by fixed point iteration.  The reference for the
+// generated tables and for calc_flow.
+//
+// The MODEL_ constants are plot_data.m's and are authoritative for the
+// firmware.  water_table.cpp and flow_table.cpp are generated from them
+// (make check_tables fails when either is stale), and test_flow_fixed
+// checks calc_flow's FLOW_ constants against them.
+#ifndef _flow_model_h
+#define _flow_model_h
+
+#include <math.h>
+
+#define MODEL_D_M (0.5 * 0.0254)    /* bluff body width, m */
+#define MODEL_PID_IN 2.9            /* pipe inner diameter, inches */
+#define MODEL_ST_A 0.2684           /* St = a - b / sqrt(Re), (7) */
+#define MODEL_ST_B 1.0356
+#define MODEL_MU_A 2.4e-5           /* mu = A 10^(B / (T_K - C)) Pa s, (10) */
+#define MODEL_MU_B 247.8
+#define MODEL_MU_C 140
+
+// dynamic viscosity of water in Pa s, (10) in plot_data.m
+static inline double model_viscosity(double T_C) {
+  return MODEL_MU_A * pow(10, MODEL_MU_B / (T_C + 273.15 - MODEL_MU_C));
+}
+
+// density of water in kg/m^3, (9) in plot_data.m
+static inline double model_density(double T_C) {
+  return 1000 * (1 - (T_C + 288.9414) / (508929.2 * (T_C + 68.12963))
+                 * (T_C - 3.9863) * (T_C - 3.9863));
+}
+
+// flow in gpm for shedding frequency f in Hz at T_C in C
+static inline double model_flow(double f, double T_C) {
+  double nu = model_viscosity(T_C) / model_density(T_C);
+  double pid_m = MODEL_PID_IN * 0.0254;
+  double v_m = 10, v_prev;
+
+  if( f <= 0 ) { return 0; }
+  for( int i=0; i<200; i++ ) {
+    double Re = v_m * pid_m / nu;
+    double St = MODEL_ST_A - MODEL_ST_B / sqrt(Re);
+    v_prev = v_m;
+    v_m = f * MODEL_D_M / St;
+    if( fabs(v_m - v_prev) < 1e-12 ) { break; }
+  }
+  return 2.45 * MODEL_PID_IN * MODEL_PID_IN * v_m * 3.2808399;
+}
+
+#endif
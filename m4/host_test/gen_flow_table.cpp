@@ -0,0 +1,54 @@
+// Writes ../flowmeter/flow_table.cpp: the plot_data.m flow model sampled
+// on the grid in flow_table.h, rounded to Q14.2 gpm.
+//
+// usage: gen_flow_table > ../flowmeter/flow_table.cpp   (make flow_table)
+#include <stdio.h>
+#include <math.h>
+
+#include "../flowmeter/flow_table.h"
+#include "flow_model.h"
+
+// one row per temperature, one column per 2^fshift Hz
+int print_table(const char *name, const char *cols_name, int cols, int fshift) {
+  printf("const unsigned short %s[FLOW_TABLE_ROWS][%s] = {\n", name, cols_name);
+  for( int r=0; r<FLOW_TABLE_ROWS; r++ ) {
+    int t = FLOW_TABLE_TMIN + (r << FLOW_TABLE_TSHIFT);
+    printf("  { // %d C\n   ", t);
+    for( int c=0; c<cols; c++ ) {
+      double gpm = model_flow(c << fshift, t);
+      long q = lround(gpm * (1 << FLOW_TABLE_FRAC));
+      if( q > 0xffff ) {
+        fprintf(stderr, "%d Hz, %d C: %.1f gpm does not fit\n", c << fshift, t, gpm);
+        return 1;
+      }
+      printf(" %5ld,", q);
+      if( c % 10 == 9 && c+1 < cols ) { printf("\n   "); }
+    }
+    printf("\n  },\n");
+  }
+  printf("};\n");
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  printf("/*--------------------------------------------------------\n");
+  printf("ECEN5003 - Project 1, Module 4\n");
+  printf("  flow_table.cpp\n");
+  printf("\n");
+  printf("  Generated by host_test/gen_flow_table, do not edit.\n");
+  printf("  Flow in gpm (Q14.2) from the plot_data.m model, one\n");
+  printf("  row per %d C from %d C, one column per %d Hz, and\n",
+         1 << FLOW_TABLE_TSHIFT, FLOW_TABLE_TMIN, 1 << FLOW_TABLE_FSHIFT);
+  printf("  per %d Hz below %d Hz.\n", 1 << FLOW_TABLE_LO_FSHIFT,
+         (FLOW_TABLE_LO_COLS - 1) << FLOW_TABLE_LO_FSHIFT);
+  printf(" --------------------------------------------------------*/\n");
+  printf("\n");
+  printf("#include \"flow_table.h\"\n");
+  printf("\n");
+  if( print_table("flow_table", "FLOW_TABLE_COLS", FLOW_TABLE_COLS, FLOW_TABLE_FSHIFT) ) {
+    return 1;
+  }
+  printf("\n");
+  return print_table("flow_table_lo", "FLOW_TABLE_LO_COLS", FLOW_TABLE_LO_COLS,
+                     FLOW_TABLE_LO_FSHIFT);
+}
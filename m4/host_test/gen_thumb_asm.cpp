@@ -0,0 +1,172 @@
+// Writes thumb_asm.s: the armcc __asm functions of the given sources in
+// GNU assembler syntax, for the host simulator (test_thumb).
+//
+// Instructions are copied as written, only the syntax around them changes:
+// ; and // comments become @, labels become local .L<function>_<label>
+// (armcc scopes them to the function) and the branches to them follow.  A
+// function named like a register, r0() in monitor.cpp, is emitted as
+// get_r0 since gas would read the name as the register.
+//
+// usage: gen_thumb_asm source... > thumb_asm.s   (make thumb_asm)
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+static string trim(const string &s) {
+  size_t b = s.find_first_not_of(" \t");
+  if( b == string::npos ) { return ""; }
+  size_t e = s.find_last_not_of(" \t;");
+  return s.substr(b, e - b + 1);
+}
+
+static bool is_register(const string &name) {
+  static const char *regs[] = { "sp", "lr", "pc" };
+  if( name.size() >= 2 && name[0] == 'r' && isdigit((unsigned char) name[1]) ) { return true; }
+  for( unsigned i=0; i<sizeof(regs)/sizeof(regs[0]); i++ ) {
+    if( name == regs[i] ) { return true; }
+  }
+  return false;
+}
+
+// splits a body line into code and comment at the first ; or //
+static void split_comment(const string &line, string *code, string *comment) {
+  size_t semi = line.find(';'), slashes = line.find("//");
+  size_t at = (semi < slashes) ? semi : slashes;
+  if( at == string::npos ) {
+    *code = trim(line);
+    *comment = "";
+    return;
+  }
+  *code = trim(line.substr(0, at));
+  size_t skip = (at == semi) ? 1 : 2;
+  *comment = trim(line.substr(at + skip));
+  // "MOVS r5, r3;     ;" leaves the second ; as the comment
+  while( !comment->empty() && (*comment)[0] == ';' ) { *comment = trim(comment->substr(1)); }
+}
+
+struct asm_func {
+  string name, file;
+  vector<string> doc;    // // lines just above the function
+  vector<string> body;   // raw lines between the braces
+};
+
+// the __asm functions of one source file, in order
+static int read_source(const char *path, vector<asm_func> *funcs) {
+  FILE *f = fopen(path, "r");
+  if( !f ) {
+    fprintf(stderr, "gen_thumb_asm: cannot open %s\n", path);
+    return 1;
+  }
+  vector<string> doc;
+  asm_func *cur = 0;
+  bool in_body = false;
+  char buf[512];
+  while( fgets(buf, sizeof(buf), f) ) {
+    string line(buf);
+    while( !line.empty() && (line.back() == '\n' || line.back() == '\r') ) { line.pop_back(); }
+    if( cur ) {
+      if( !in_body ) {
+        in_body = line.find('{') != string::npos;
+        continue;
+      }
+      if( trim(line) == "}" ) { cur = 0; in_body = false; continue; }
+      cur->body.push_back(line);
+      continue;
+    }
+    if( line.compare(0, 6, "__asm ") == 0 ) {
+      size_t paren = line.find('(');
+      size_t start = line.find_last_of(" *", paren - 1) + 1;
+      funcs->push_back(asm_func());
+      cur = &funcs->back();
+      cur->name = line.substr(start, paren - start);
+      cur->file = path;
+      cur->doc = doc;
+      in_body = line.find('{') != string::npos;
+    }
+    string t = trim(line);
+    if( t.compare(0, 2, "//") == 0 && t.find_first_not_of("/*") != string::npos ) {
+      doc.push_back(trim(t.substr(2)));
+    } else {
+      doc.clear();
+    }
+  }
+  fclose(f);
+  return 0;
+}
+
+static void print_func(const asm_func &fn) {
+  string name = is_register(fn.name) ? "get_" + fn.name : fn.name;
+  vector<string> labels;
+  for( unsigned i=0; i<fn.body.size(); i++ ) {
+    const string &line = fn.body[i];
+    if( !line.empty() && !isspace((unsigned char) line[0]) && line.compare(0, 2, "//") != 0 ) {
+      string code, comment;
+      split_comment(line, &code, &comment);
+      labels.push_back(code);
+    }
+  }
+
+  printf("\n@ %s in %s\n", fn.name.c_str(), fn.file.c_str());
+  for( unsigned i=0; i<fn.doc.size(); i++ ) { printf("@ %s\n", fn.doc[i].c_str()); }
+  printf("  .global %s\n", name.c_str());
+  printf("  .type %s, %%function\n", name.c_str());
+  printf("  .thumb_func\n");
+  printf("%s:\n", name.c_str());
+  bool blank = false;
+  for( unsigned i=0; i<fn.body.size(); i++ ) {
+    string code, comment;
+    split_comment(fn.body[i], &code, &comment);
+    bool label = !fn.body[i].empty() && !isspace((unsigned char) fn.body[i][0]) &&
+                 fn.body[i].compare(0, 2, "//") != 0;
+    if( code.empty() && comment.empty() ) {
+      blank = true;
+      continue;
+    }
+    if( blank ) { printf("\n"); blank = false; }
+    if( label ) {
+      printf(".L%s_%s:", name.c_str(), code.c_str());
+    } else if( !code.empty() ) {
+      // a branch to one of this function's labels
+      size_t last = code.find_last_of(" \t,") + 1;
+      string target = code.substr(last);
+      for( unsigned j=0; j<labels.size(); j++ ) {
+        if( target == labels[j] ) {
+          code = code.substr(0, last) + ".L" + name + "_" + target;
+          break;
+        }
+      }
+      printf("  %s", code.c_str());
+    } else {
+      printf("  ");
+    }
+    if( !comment.empty() ) { printf("%s@ %s", code.empty() ? "" : "  ", comment.c_str()); }
+    printf("\n");
+  }
+  printf("  .size %s, . - %s\n", name.c_str(), name.c_str());
+}
+
+int main(int argc, char *argv[]) {
+  vector<asm_func> funcs;
+  for( int i=1; i<argc; i++ ) {
+    if( read_source(argv[i], &funcs) ) { return 1; }
+  }
+  if( funcs.empty() ) {
+    fprintf(stderr, "gen_thumb_asm: no __asm functions\n");
+    return 1;
+  }
+
+  printf("@ Generated by host_test/gen_thumb_asm from the armcc __asm routines,\n");
+  printf("@ do not edit.  GNU assembler syntax for the host simulator (test_thumb).\n");
+  printf("\n");
+  printf("  .syntax unified\n");
+  printf("  .cpu cortex-m0plus\n");
+  printf("  .thumb\n");
+  printf("  .text\n");
+  for( unsigned i=0; i<funcs.size(); i++ ) { print_func(funcs[i]); }
+  return 0;
+}
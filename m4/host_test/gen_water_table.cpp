@@ -0,0 +1,43 @@
+// Writes ../flowmeter/water_table.cpp: density and viscosity of water at
+// every C in water_table.h, rounded to their Q formats.
+//
+// Density is (9) and viscosity (10) of plot_data.m, as in flow_model.h.
+//
+// usage: gen_water_table > ../flowmeter/water_table.cpp   (make water_table)
+#include <stdio.h>
+#include <math.h>
+
+#include "../flowmeter/water_table.h"
+#include "flow_model.h"
+
+int main(int argc, char *argv[]) {
+  printf("/*--------------------------------------------------------\n");
+  printf("ECEN5003 - Project 1, Module 4\n");
+  printf("  water_table.cpp\n");
+  printf("\n");
+  printf("  Generated by host_test/gen_water_table, do not edit.\n");
+  printf("  Density in kg/m^3 (Q10.6) and viscosity in mPa s\n");
+  printf("  (Q16.16) of water, one entry per C from %d C.\n", WATER_TABLE_TMIN);
+  printf(" --------------------------------------------------------*/\n");
+  printf("\n");
+  printf("#include \"water_table.h\"\n");
+  printf("\n");
+  printf("const unsigned short water_density[WATER_TABLE_ROWS] = {\n ");
+  for( int i=0; i<WATER_TABLE_ROWS; i++ ) {
+    long q = lround(model_density(WATER_TABLE_TMIN + i) * 64);
+    if( q > 0xffff ) {
+      fprintf(stderr, "%d C: density does not fit\n", WATER_TABLE_TMIN + i);
+      return 1;
+    }
+    printf(" %5ld,", q);
+    if( i % 10 == 9 && i+1 < WATER_TABLE_ROWS ) { printf("\n "); }
+  }
+  printf("\n};\n\n");
+  printf("const unsigned int water_viscosity[WATER_TABLE_ROWS] = {\n ");
+  for( int i=0; i<WATER_TABLE_ROWS; i++ ) {
+    printf(" %7ld,", lround(model_viscosity(WATER_TABLE_TMIN + i) * 1000 * 65536));
+    if( i % 8 == 7 && i+1 < WATER_TABLE_ROWS ) { printf("\n "); }
+  }
+  printf("\n};\n");
+  return 0;
+}
@@ -0,0 +1,18 @@
+// Timing for the host benchmarks at the end of the tests: wall clock in
+// ns, and the x86 time stamp counter where there is one (HAVE_TSC).
+#ifndef _host_timing_h
+#define _host_timing_h
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC
+#endif
+
+static inline double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,172 @@
+// Host build of the biquad band-pass front end in biquad.cpp.
+//
+// Each band's fixed point response is checked against the exact response
+// of its quantized coefficients, and DC must settle to zero.  Then the
+// crossing detector in freq_sample is run behind the moving average and
+// behind each band on shedding tones with synthetic noise: 60 Hz pickup,
+// white noise and a 4.5 kHz interferer, and the frequency errors compared.
+// The best band for each tone has to meet the error bounds.
+//
+// usage: test_biquad
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../flowmeter/flow_calc.h"
+#include "../flowmeter/biquad.h"
+#include "host_timing.h"
+
+// |H(f)| of the cascade with the quantized coefficients, in double
+double band_gain(const biquad_band *band, double f) {
+  double w = 2 * M_PI * f / 10000.0;
+  double gain = 1;
+  for( int k=0; k<band->stages; k++ ) {
+    const biquad_coef *c = &band->coef[k];
+    double s = 1 << BIQUAD_SHIFT;
+    double nr = c->b0 + c->b1 * cos(w) + c->b2 * cos(2*w);
+    double ni = -c->b1 * sin(w) - c->b2 * sin(2*w);
+    double dr = s + c->a1 * cos(w) + c->a2 * cos(2*w);
+    double di = -c->a1 * sin(w) - c->a2 * sin(2*w);
+    gain *= hypot(nr, ni) / hypot(dr, di);
+  }
+  return gain;
+}
+
+// fixed point response: peak output over the last 2000 of 4000 samples of
+// a sine, against the exact gain.  Deep stopband gains are compared in
+// absolute terms, rounding leaves a few LSBs.
+int test_response(const biquad_band *band) {
+  static const double freqs[] = { 60, 100, 300, 1000, 2000, 3000, 4500 };
+  const double amp = 4000;
+  biquad_state bs;
+  int failed = 0;
+
+  printf("TEST: biquad response, %s\n", band->name);
+  printf("--------------------------------------\n");
+  for( unsigned i=0; i<sizeof(freqs)/sizeof(freqs[0]); i++ ) {
+    double f = freqs[i], peak = 0;
+    biquad_reset(&bs, band);
+    for( int n=0; n<4000; n++ ) {
+      int y = biquad_sample(&bs, (int) lround(amp * sin(2 * M_PI * f * n / 10000.0)));
+      if( n >= 2000 && abs(y) > peak ) { peak = abs(y); }
+    }
+    double expected = amp * band_gain(band, f);
+    printf("  %6.0f Hz: %7.1f dB, exact %7.1f dB\n",
+           f, 20 * log10(peak / amp + 1e-9), 20 * log10(expected / amp));
+    if( fabs(peak - expected) > 0.02 * expected + 4 ) {
+      printf("FAILED: off the exact response\n");
+      failed++;
+    }
+  }
+
+  // an adc offset is no signal: a large step must decay to within an LSB
+  biquad_reset(&bs, band);
+  int y = 0;
+  for( int n=0; n<10000; n++ ) { y = biquad_sample(&bs, 4000); }
+  printf("  DC step of 4000: output %d after 1 s\n", y);
+  if( abs(y) > 1 ) {
+    printf("FAILED: DC not rejected\n");
+    failed++;
+  }
+  printf(failed ? "Failed\n\n" : "Passed\n\n");
+  return failed;
+}
+
+// shedding tone with 60 Hz pickup, white noise and an interferer near
+// Nyquist, clipped to the adc range
+struct noisy {
+  double f, amp, hum, white, hf;
+};
+
+unsigned short noisy_sample(const noisy *s, int n) {
+  double v = 0x8000 + s->amp * sin(2 * M_PI * s->f * n / 10000.0 + 0.4)
+             + s->hum * sin(2 * M_PI * 60 * n / 10000.0)
+             + s->hf * sin(2 * M_PI * 4500 * n / 10000.0 + 1.1)
+             + s->white * ((rand() % 2001) - 1000) / 1000.0;
+  if( v < 0 ) { v = 0; }
+  if( v > 65535 ) { v = 65535; }
+  return (unsigned short) v;
+}
+
+// worst error over 10 windows, counting or timing crossings, behind the
+// given filter (0 for the moving average); the first window is skipped
+double crossing_error(const noisy *s, const biquad_band *band, int period_mode) {
+  double worst = 0;
+  int windows = 0;
+
+  srand(5003);
+  freq_reset(&vortex);
+  vortex.band = band;
+  biquad_reset(&vortex.bq, band);
+  vortex.period_mode = period_mode;
+  vortex.tracking = 0;  // fixed thresholds, the filter alone
+  for( int n=0; windows<11; n++ ) {
+    if( freq_sample(&vortex, noisy_sample(s, n)) ) {
+      double err = fabs(freq_q8 / 256.0 - s->f);
+      if( windows > 0 && err > worst ) { worst = err; }
+      windows++;
+    }
+  }
+  return worst;
+}
+
+// counting quantizes to 10 Hz per 1000 sample window, so up to 10 Hz is
+// no error there
+int test_robustness(const char *name, noisy s, double max_count, double max_period) {
+  double best_count = 1e9, best_period = 1e9;
+
+  printf("TEST: crossing robustness, %s, %.1f Hz\n", name, s.f);
+  printf("--------------------------------------------------\n");
+  printf("  %-20s %12s %12s\n", "filter", "counting", "period");
+  printf("  %-20s %10.2f Hz %10.2f Hz\n", "5-tap average",
+         crossing_error(&s, 0, 0), crossing_error(&s, 0, 1));
+  for( int b=0; b<vortex_band_count; b++ ) {
+    const biquad_band *band = &vortex_bands[b];
+    // only bands that pass the tone
+    if( band_gain(band, s.f) < 0.5 ) { continue; }
+    double count_err = crossing_error(&s, band, 0);
+    double period_err = crossing_error(&s, band, 1);
+    printf("  %-20s %10.2f Hz %10.2f Hz\n", band->name, count_err, period_err);
+    if( count_err < best_count ) { best_count = count_err; }
+    if( period_err < best_period ) { best_period = period_err; }
+  }
+  if( best_count > max_count || best_period > max_period ) {
+    printf("FAILED: error bounds %.1f Hz counting, %.2f Hz period\n\n", max_count, max_period);
+    return 1;
+  }
+  printf("Passed\n\n");
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  int failed = 0;
+
+  for( int b=0; b<vortex_band_count; b++ ) {
+    failed += test_response(&vortex_bands[b]);
+  }
+
+  failed += test_robustness("clean", noisy{ 1000.0, 8000, 0, 0, 0 }, 10, 0.1);
+  failed += test_robustness("60 Hz pickup", noisy{ 1000.0, 4000, 6000, 0, 0 }, 10, 0.5);
+  failed += test_robustness("60 Hz pickup", noisy{ 412.3, 4000, 6000, 0, 0 }, 10, 0.5);
+  failed += test_robustness("white noise", noisy{ 1000.0, 4000, 0, 1500, 0 }, 10, 1.0);
+  failed += test_robustness("4.5 kHz interferer", noisy{ 1000.0, 4000, 0, 0, 4000 }, 10, 0.5);
+  failed += test_robustness("all three", noisy{ 2345.6, 6000, 6000, 1500, 3000 }, 10, 1.0);
+  failed += test_robustness("all three", noisy{ 180.0, 6000, 3000, 1500, 3000 }, 10, 1.0);
+
+  // host time per sample, filter and detector
+  for( int b=-1; b<vortex_band_count; b++ ) {
+    const biquad_band *band = (b < 0) ? 0 : &vortex_bands[b];
+    int (* volatile sample_fn)(vortex_state *, unsigned short) = &freq_sample;
+    int sum = 0;
+    freq_reset(&vortex);
+    vortex.band = band;
+    biquad_reset(&vortex.bq, band);
+    double t_start = now_ns();
+    for( int n=0; n<1000000; n++ ) { sum += sample_fn(&vortex, adc_test_data[n % VORTEX_INPUT_SIZE]); }
+    printf("host time per freq_sample, %s: %.1f ns (%d)\n",
+           band ? band->name : "5-tap average", (now_ns() - t_start) / 1000000, sum);
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,293 @@
+// Host build of the CIC decimator in cic.cpp.
+//
+// cic.cpp is the target code, so this is a bit-exact model of the board.
+// Its wrapping 32-bit integrators and combs are checked sample for sample
+// against the direct convolution with the CIC impulse response in 64 bits,
+// for every decimation and for inputs at the rails.  Then the response:
+// unity DC gain, nulls against aliases from around multiples of the
+// output rate, and the noise reduction.  Last, freq_sample behind the CIC
+// against taking every R-th sample, with noise and an interferer that
+// aliases into the shedding band, and the host time per input sample.
+//
+// usage: test_cic
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../flowmeter/flow_calc.h"
+#include "../flowmeter/cic.h"
+#include "host_timing.h"
+
+#define TEST_SAMPLES 40000  /* input samples */
+#define FS_OUT 10000.0      /* output rate, the tick */
+
+// impulse response of CIC_ORDER cascaded R-sample sums, length
+// CIC_ORDER * (R-1) + 1, returns the length
+int cic_impulse(int decim, int64_t *h) {
+  int len = 1;
+  h[0] = 1;
+  for( int k=0; k<CIC_ORDER; k++ ) {
+    int64_t prev[CIC_ORDER * CIC_MAX_DECIM];
+    for( int i=0; i<len; i++ ) { prev[i] = h[i]; }
+    len += decim - 1;
+    for( int i=0; i<len; i++ ) {
+      h[i] = 0;
+      for( int j=0; j<decim; j++ ) {
+        if( i - j >= 0 && i - j < len - decim + 1 ) { h[i] += prev[i - j]; }
+      }
+    }
+  }
+  return len;
+}
+
+int test_bit_exact(const char *name, const unsigned short *vals) {
+  int64_t h[CIC_ORDER * CIC_MAX_DECIM];
+  int failed = 0;
+
+  printf("TEST: cic_sample vs direct convolution, %s\n", name);
+  printf("------------------------------------------------------\n");
+  for( int decim=2; decim<=CIC_MAX_DECIM; decim++ ) {
+    cic_state cs;
+    int len = cic_impulse(decim, h);
+    int outputs = 0;
+
+    cic_reset(&cs, decim);
+    for( int n=0; n<TEST_SAMPLES; n++ ) {
+      unsigned short out;
+      if( !cic_sample(&cs, vals[n], &out) ) { continue; }
+      int64_t acc = 0;
+      for( int j=0; j<len && j<=n; j++ ) { acc += h[j] * vals[n - j]; }
+      unsigned short expected = (unsigned short) (acc >> cs.shift);
+      if( out != expected || (n + 1) % decim ) {
+        printf("FAILED: R %d, input %d, got 0x%04x, but expected 0x%04x\n",
+               decim, n, out, expected);
+        if( ++failed > 10 ) { return failed; }
+      }
+      outputs++;
+    }
+    if( outputs != TEST_SAMPLES / decim ) {
+      printf("FAILED: R %d, %d outputs\n", decim, outputs);
+      failed++;
+    }
+  }
+  if( failed ) {
+    printf("Failed %d\n\n", failed);
+  } else {
+    printf("Passed R 2..%d\n\n", CIC_MAX_DECIM);
+  }
+  return failed;
+}
+
+// exact gain of the filter at f, relative to DC, fs_in = R * FS_OUT
+double cic_gain(int decim, double f) {
+  double x = M_PI * f / (decim * FS_OUT);
+  if( fabs(sin(x)) < 1e-12 ) { return 1; }
+  return pow(fabs(sin(decim * x) / (decim * sin(x))), CIC_ORDER);
+}
+
+// amplitude of f in the decimated output, by correlation over whole cycles
+double tone_amplitude(const unsigned short *out, int n, double f) {
+  double re = 0, im = 0, mean = 0;
+  for( int i=0; i<n; i++ ) { mean += out[i]; }
+  mean /= n;
+  for( int i=0; i<n; i++ ) {
+    re += (out[i] - mean) * cos(2 * M_PI * f * i / FS_OUT);
+    im += (out[i] - mean) * sin(2 * M_PI * f * i / FS_OUT);
+  }
+  return 2 * hypot(re, im) / n;
+}
+
+int test_response(void) {
+  static unsigned short vals[TEST_SAMPLES], out[TEST_SAMPLES];
+  static const int decims[] = { 4, 8, 16, 32 };
+  int failed = 0;
+
+  printf("TEST: CIC response, output at %.0f Hz\n", FS_OUT);
+  printf("--------------------------------------------------------------\n");
+  for( unsigned d=0; d<sizeof(decims)/sizeof(decims[0]); d++ ) {
+    int decim = decims[d];
+    cic_state cs;
+    int n;
+
+    // DC gain is exactly 1 for R a power of two, past the fill
+    cic_reset(&cs, decim);
+    unsigned short dc = 0;
+    for( int i=0; i<TEST_SAMPLES; i++ ) { cic_sample(&cs, 0xabcd, &dc); }
+    printf("  R %2d: DC 0xabcd -> 0x%04x\n", decim, dc);
+    if( dc != 0xabcd ) {
+      printf("FAILED: DC gain\n");
+      failed++;
+    }
+
+    // a 1 kHz tone, and tones at multiples of the output rate +/- 1 kHz,
+    // which alias onto 1 kHz.  Plain decimation passes them at full size.
+    for( int k=0; k<=3 && k<decim/2; k++ ) {
+      for( int sign=-1; sign<=1; sign+=2 ) {
+        double f = k * FS_OUT + sign * 1000.0;
+        if( f < 0 || (k == 0 && sign < 0) ) { continue; }
+        for( int i=0; i<TEST_SAMPLES; i++ ) {
+          vals[i] = (unsigned short) lround(0x8000 + 20000 * sin(2 * M_PI * f * i / (decim * FS_OUT) + 0.3));
+        }
+        cic_reset(&cs, decim);
+        n = 0;
+        for( int i=0; i<TEST_SAMPLES; i++ ) {
+          if( cic_sample(&cs, vals[i], &out[n]) ) { n++; }
+        }
+        // skip the fill, keep whole 1 kHz cycles
+        int skip = CIC_ORDER, used = (n - skip) / 10 * 10;
+        double amp = tone_amplitude(out + skip, used, 1000.0);
+        double expected = 20000 * cic_gain(decim, f);
+        printf("  R %2d: %6.0f Hz -> 1 kHz at %7.1f dB, exact %7.1f dB\n", decim, f,
+               20 * log10(amp / 20000 + 1e-9), 20 * log10(expected / 20000));
+        if( fabs(amp - expected) > 0.01 * expected + 2 ) {
+          printf("FAILED: off the exact response\n");
+          failed++;
+        }
+      }
+    }
+  }
+  printf(failed ? "Failed\n\n" : "Passed\n\n");
+  return failed;
+}
+
+// white noise on a DC input: rms at the output, against the input rms
+// times the exact noise gain sqrt(sum h^2) / R^CIC_ORDER
+int test_noise(int decim) {
+  static unsigned short out[TEST_SAMPLES];
+  int64_t h[CIC_ORDER * CIC_MAX_DECIM];
+  int len = cic_impulse(decim, h);
+  double sum2 = 0, gain = 1;
+  cic_state cs;
+  int n = 0;
+
+  for( int j=0; j<len; j++ ) { sum2 += (double) h[j] * h[j]; }
+  for( int k=0; k<CIC_ORDER; k++ ) { gain *= decim; }
+
+  srand(5003);
+  double in_var = 0;
+  cic_reset(&cs, decim);
+  for( int i=0; i<TEST_SAMPLES * 4; i++ ) {
+    int noise = (rand() % 4001) - 2000;
+    in_var += (double) noise * noise;
+    if( cic_sample(&cs, (unsigned short) (0x8000 + noise), &out[n]) ) { n++; }
+  }
+  double in_rms = sqrt(in_var / (TEST_SAMPLES * 4));
+  double out_var = 0;
+  for( int i=CIC_ORDER; i<n; i++ ) { out_var += (out[i] - 32768.0) * (out[i] - 32768.0); }
+  double out_rms = sqrt(out_var / (n - CIC_ORDER));
+  double expected = in_rms * sqrt(sum2) / gain;
+
+  printf("TEST: noise, R %d\n", decim);
+  printf("------------------\n");
+  printf("  rms %.1f in, %.1f out (%.1f dB), exact %.1f\n", in_rms, out_rms,
+         20 * log10(out_rms / in_rms), expected);
+  // the output is truncated, a uniform 1/sqrt(12) LSB of noise on top
+  if( fabs(out_rms - expected) > 0.05 * expected + 0.5 ) {
+    printf("FAILED: noise gain\n\n");
+    return 1;
+  }
+  printf("Passed\n\n");
+  return 0;
+}
+
+// worst error over windows 2.. of freq_sample on the oversampled input,
+// through the CIC or by taking every R-th sample
+double decimated_error(const unsigned short *vals, int n, double f, int decim, int use_cic) {
+  double worst = 0;
+  int windows = 0;
+  cic_state cs;
+
+  freq_reset(&vortex);
+  cic_reset(&cs, decim);
+  for( int i=0; i<n; i++ ) {
+    unsigned short v;
+    if( use_cic ) {
+      if( !cic_sample(&cs, vals[i], &v) ) { continue; }
+    } else {
+      if( (i + 1) % decim ) { continue; }
+      v = vals[i];
+    }
+    if( freq_sample(&vortex, v) ) {
+      double err = fabs(freq_q8 / 256.0 - f);
+      if( windows >= 2 && err > worst ) { worst = err; }
+      windows++;
+    }
+  }
+  return worst;
+}
+
+// shedding tone sampled at R times the tick, with white noise and an
+// interferer at 7.2 kHz, which every R-th sample aliases to 2.8 kHz, inside
+// the band-pass.  The CIC takes it down 30 dB or more first.
+int test_estimate(double f, int decim) {
+  const int n = 80000 / 16 * decim;  // 8 windows
+  unsigned short *vals = new unsigned short[n];
+  double interferer = FS_OUT - 2800;
+
+  srand(5003);
+  for( int i=0; i<n; i++ ) {
+    double t = i / (decim * FS_OUT);
+    double v = 0x8000 + 4000 * sin(2 * M_PI * f * t) + 6000 * sin(2 * M_PI * interferer * t + 0.7)
+               + 3000 * ((rand() % 2001) - 1000) / 1000.0;
+    vals[i] = (unsigned short) v;
+  }
+  double plain_count = decimated_error(vals, n, f, decim, 0);
+  double cic_count = decimated_error(vals, n, f, decim, 1);
+
+  printf("TEST: %.1f Hz at %.0f ksps, noise and a %.0f Hz interferer, R %d\n",
+         f, decim * FS_OUT / 1000, interferer, decim);
+  printf("--------------------------------------------------------------------\n");
+  printf("  CIC gain at %.0f Hz: %.1f dB\n", interferer, 20 * log10(cic_gain(decim, interferer)));
+  printf("  every R-th sample: worst error %8.2f Hz\n", plain_count);
+  printf("  CIC:               worst error %8.2f Hz\n", cic_count);
+  delete[] vals;
+  if( cic_count > 1.0 ) {
+    printf("FAILED: error bound 1 Hz behind the CIC\n\n");
+    return 1;
+  }
+  printf("Passed\n\n");
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  static unsigned short vals[TEST_SAMPLES];
+  int failed = 0;
+
+  srand(5003);
+  for( int i=0; i<TEST_SAMPLES; i++ ) { vals[i] = (unsigned short) rand(); }
+  failed += test_bit_exact("random", vals);
+  for( int i=0; i<TEST_SAMPLES; i++ ) { vals[i] = 0xffff; }
+  failed += test_bit_exact("full scale", vals);
+  for( int i=0; i<TEST_SAMPLES; i++ ) { vals[i] = ((i / 7) & 1) ? 0xffff : 0; }
+  failed += test_bit_exact("rail to rail square", vals);
+
+  failed += test_response();
+  failed += test_noise(4);
+  failed += test_noise(16);
+  failed += test_noise(32);
+
+  failed += test_estimate(1000.0, CIC_DECIM);
+  failed += test_estimate(412.3, CIC_DECIM);
+  failed += test_estimate(1234.5, 8);
+
+  // host time per input sample
+  for( int i=0; i<TEST_SAMPLES; i++ ) { vals[i] = (unsigned short) rand(); }
+  for( int decim=4; decim<=CIC_MAX_DECIM; decim*=2 ) {
+    int (* volatile sample_fn)(cic_state *, unsigned short, unsigned short *) = &cic_sample;
+    unsigned short out;
+    unsigned int sum = 0;
+    cic_state cs;
+    cic_reset(&cs, decim);
+    double t_start = now_ns();
+    for( int r=0; r<50; r++ ) {
+      for( int i=0; i<TEST_SAMPLES; i++ ) {
+        if( sample_fn(&cs, vals[i], &out) ) { sum += out; }
+      }
+    }
+    printf("host time per input sample, R %2d: %.2f ns (%u)\n",
+           decim, (now_ns() - t_start) / 50 / TEST_SAMPLES, sum);
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+// Host build of the integer calc_flow in flow_calc.cpp, against its float
+// reference calc_flow_float.
+//
+// Both are run over the whole operating envelope, every Hz from 1 to
+// 5000 at every C from -40 to 125, and past it to the saturation limits.
+// They must agree to within 1 gpm, the truncation of the result.  Before
+// truncation, calc_flow's closed-form Strouhal solve must be within
+// MAX_SOLVE_GPM of the plot_data.m model (flow_model.h), iterated in
+// double until it stops moving, and its constants must be the model's.
+// Ends with the time per call of both; the Makefile prints their code
+// sizes.
+//
+// usage: test_flow_fixed
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../flowmeter/flow_calc.h"
+#include "flow_model.h"
+#include "host_timing.h"
+
+#define MAX_SOLVE_GPM 0.01
+
+int test_envelope(int f_lo, int f_hi, int t_lo, int t_hi, int max_dev) {
+  int worst = 0, worst_f = 0, worst_t = 0, differ = 0, count = 0;
+
+  printf("TEST: calc_flow vs calc_flow_float, %d to %d Hz, %d to %d C\n", f_lo, f_hi, t_lo, t_hi);
+  printf("------------------------------------------------------------\n");
+  for( int t=t_lo; t<=t_hi; t++ ) {
+    for( int f=f_lo; f<=f_hi; f++ ) {
+      int fixed = calc_flow(f, t);
+      int ref = calc_flow_float(f, t);
+      int dev = abs(fixed - ref);
+      if( dev ) { differ++; }
+      if( dev > worst ) { worst = dev; worst_f = f; worst_t = t; }
+      count++;
+    }
+  }
+  printf("  worst difference %d gpm at %d Hz, %d C (%d gpm against %d)\n", worst, worst_f,
+         worst_t, calc_flow(worst_f, worst_t), calc_flow_float(worst_f, worst_t));
+  printf("  %d of %d results differ\n", differ, count);
+  if( worst > max_dev ) {
+    printf("FAILED: more than %d gpm apart\n\n", max_dev);
+    return 1;
+  }
+  printf("Passed\n\n");
+  return 0;
+}
+
+// the plot_data.m model of flow_model.h, iterated to convergence in
+// double and not truncated, counting the steps it takes
+double flow_iterated(int freq, int temp, int *iterations) {
+  double nu = model_viscosity(temp) / model_density(temp);
+  double pid_m = MODEL_PID_IN * 0.0254;
+  double v_m = 10, v_m_prev;
+  int i = 0;
+  do {
+    double St = MODEL_ST_A - MODEL_ST_B / sqrt(v_m * pid_m / nu);
+    v_m_prev = v_m;
+    v_m = freq * MODEL_D_M / St;
+  } while( fabs(v_m - v_m_prev) > 1e-12 && ++i < 1000 );
+  *iterations = i;
+  return 2.45 * MODEL_PID_IN * MODEL_PID_IN * 3.2808399 * v_m;
+}
+
+int test_solve(int f_lo, int f_hi, int t_lo, int t_hi) {
+  double worst = 0;
+  int worst_f = 0, worst_t = 0, most = 0;
+
+  printf("TEST: calc_flow closed form vs iteration, %d to %d Hz, %d to %d C\n", f_lo, f_hi,
+         t_lo, t_hi);
+  printf("----------------------------------------------------------------------\n");
+  for( int t=t_lo; t<=t_hi; t++ ) {
+    for( int f=f_lo; f<=f_hi; f++ ) {
+      int iterations;
+      double ref = flow_iterated(f, t, &iterations);
+      calc_flow(f, t);
+      double dev = fabs(flow_q8 / 256.0 - ref);
+      if( dev > worst ) { worst = dev; worst_f = f; worst_t = t; }
+      if( iterations > most ) { most = iterations; }
+    }
+  }
+  int iterations;
+  double ref = flow_iterated(worst_f, worst_t, &iterations);
+  calc_flow(worst_f, worst_t);
+  printf("  worst difference %.4f gpm at %d Hz, %d C (%.4f gpm against %.4f)\n", worst,
+         worst_f, worst_t, flow_q8 / 256.0, ref);
+  printf("  the iteration took up to %d steps to settle in double\n", most);
+  if( worst > MAX_SOLVE_GPM ) {
+    printf("FAILED: more than %.2f gpm apart\n\n", MAX_SOLVE_GPM);
+    return 1;
+  }
+  printf("Passed\n\n");
+  return 0;
+}
+
+// calc_flow's constants in flow_calc.h against the ones they are derived
+// from in flow_model.h, so a change to either shows up here
+int test_constants(void) {
+  const double gpm_hz = 2.45 * MODEL_PID_IN * MODEL_PID_IN * 3.2808399 * MODEL_D_M;
+  const struct { const char *name; double got, expected; } c[] = {
+    { "FLOW_BETA_Q28", FLOW_BETA_Q28, MODEL_ST_B * 8 * 268435456.0 },
+    { "FLOW_INV_4A_Q31", FLOW_INV_4A_Q31, 2147483648.0 / (4 * MODEL_ST_A) },
+    { "FLOW_SQRT_4A_Q31", FLOW_SQRT_4A_Q31, sqrt(4 * MODEL_ST_A) * 2147483648.0 },
+    { "FLOW_INV_2A_Q30", FLOW_INV_2A_Q30, 1073741824.0 / (2 * MODEL_ST_A) },
+    { "FLOW_GPM_HZ_Q24", FLOW_GPM_HZ_Q24, gpm_hz / MODEL_ST_A * 16777216.0 },
+  };
+  int failed = 0;
+
+  printf("TEST: calc_flow constants from the model, a = %g, b = %g\n", MODEL_ST_A, MODEL_ST_B);
+  printf("------------------------------------------------------------\n");
+  for( unsigned i=0; i<sizeof(c)/sizeof(c[0]); i++ ) {
+    double rel = fabs(c[i].got - c[i].expected) / c[i].expected;
+    printf("  %-18s %10.0f, model %12.1f\n", c[i].name, c[i].got, c[i].expected);
+    if( rel > 1e-6 ) {
+      printf("FAILED: %s is %.2g off the model\n", c[i].name, rel);
+      failed++;
+    }
+  }
+  printf(failed ? "Failed\n\n" : "Passed\n\n");
+  return failed;
+}
+
+int main(int argc, char *argv[]) {
+  int failed = 0;
+
+  failed += test_constants();
+  failed += test_envelope(1, 5000, -40, 125, 1);
+  failed += test_solve(1, 5000, -40, 125);
+
+  // saturation: frequency and temperature past the limits, zero flow
+  printf("TEST: calc_flow saturation\n");
+  printf("--------------------------\n");
+  int at_max = calc_flow(FLOW_FREQ_MAX, 23);
+  int sat_fail = 0;
+  if( calc_flow(FLOW_FREQ_MAX + 1000, 23) != at_max ) { sat_fail++; }
+  if( calc_flow(1000, -100) != calc_flow(1000, FLOW_TEMP_MIN) ) { sat_fail++; }
+  if( calc_flow(1000, 300) != calc_flow(1000, FLOW_TEMP_MAX) ) { sat_fail++; }
+  if( calc_flow(0, 23) != 0 || calc_flow(-5, 23) != 0 ) { sat_fail++; }
+  printf("  %d Hz: %d gpm, float %d gpm\n", FLOW_FREQ_MAX, at_max,
+         calc_flow_float(FLOW_FREQ_MAX, 23));
+  if( abs(at_max - calc_flow_float(FLOW_FREQ_MAX, 23)) > 1 ) { sat_fail++; }
+  printf(sat_fail ? "FAILED: limits\n\n" : "Passed\n\n");
+  failed += sat_fail;
+
+  // host time per call over the envelope
+  static int fs[1024], ts[1024];
+  srand(5003);
+  for( int i=0; i<1024; i++ ) {
+    fs[i] = 1 + rand() % 5000;
+    ts[i] = -40 + rand() % 166;
+  }
+  int (* volatile float_fn)(int, int) = &calc_flow_float;
+  int (* volatile fixed_fn)(int, int) = &calc_flow;
+  const int reps = 100;
+  int sum = 0;
+  double t_start = now_ns();
+#ifdef HAVE_TSC
+  unsigned long long c_start = __rdtsc();
+#endif
+  for( int r=0; r<reps; r++ ) {
+    for( int i=0; i<1024; i++ ) { sum += float_fn(fs[i], ts[i]); }
+  }
+  double ns_float = (now_ns() - t_start) / reps / 1024;
+#ifdef HAVE_TSC
+  double cyc_float = (double) (__rdtsc() - c_start) / reps / 1024;
+  c_start = __rdtsc();
+#endif
+  t_start = now_ns();
+  for( int r=0; r<reps; r++ ) {
+    for( int i=0; i<1024; i++ ) { sum += fixed_fn(fs[i], ts[i]); }
+  }
+  double ns_fixed = (now_ns() - t_start) / reps / 1024;
+#ifdef HAVE_TSC
+  double cyc_fixed = (double) (__rdtsc() - c_start) / reps / 1024;
+  printf("host time per call: calc_flow_float %.1f ns (%.0f TSC cycles), calc_flow %.1f ns "
+         "(%.0f TSC cycles), %.1fx (%d)\n", ns_float, cyc_float, ns_fixed, cyc_fixed,
+         ns_float / ns_fixed, sum);
+#else
+  printf("host time per call: calc_flow_float %.1f ns, calc_flow %.1f ns, %.1fx (%d)\n",
+         ns_float, ns_fixed, ns_float / ns_fixed, sum);
+#endif
+
+  return failed ? 1 : 0;
+}
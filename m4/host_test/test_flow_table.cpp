@@ -0,0 +1,184 @@
+// Host build of flow_lookup in flow_calc.cpp and the generated
+// flow_table.cpp.
+//
+// The lookup is swept over the shedding range in 1/16 Hz steps and over
+// -40..125 C against the plot_data.m model in double (flow_model.h).  It
+// must stay within MAX_DEV_GPM of the model and never fall as frequency
+// rises.  It is then checked against calc_flow up to the 4992 Hz table
+// edge, and for holding its edge value beyond it, and calc_flow is shown
+// against the model for comparison.  Ends with the time per call of both.
+//
+// usage: test_flow_table
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../flowmeter/flow_calc.h"
+#include "../flowmeter/flow_table.h"
+#include "flow_model.h"
+#include "host_timing.h"
+
+#define MAX_DEV_GPM 1.5  /* interpolation plus rounding to whole gpm */
+#define MAX_CALC_DIFF_GPM 2  /* both within a gpm of the model, truncated vs rounded */
+
+int test_surface(void) {
+  double worst = 0, worst_rel = 0;
+  int worst_f = 0, worst_t = 0, worst_rel_f = 0, worst_rel_t = 0;
+  int failed = 0;
+
+  printf("TEST: flow_lookup vs the plot_data.m model, 1 to 4992 Hz, -40 to 125 C\n");
+  printf("------------------------------------------------------------------------\n");
+  for( int t=-40; t<=125; t++ ) {
+    int prev = 0;
+    for( int f_q8=16; f_q8<=(4992 << 8); f_q8+=16 ) {
+      int got = flow_lookup(f_q8, t);
+      if( got < prev ) {
+        printf("FAILED: %.4f Hz, %d C: %d gpm, below %d at the step before\n",
+               f_q8 / 256.0, t, got, prev);
+        if( ++failed > 10 ) { return failed; }
+      }
+      prev = got;
+      // every 1.0625 Hz against the model, the sweep is slow enough
+      if( f_q8 % 272 ) { continue; }
+      double expected = model_flow(f_q8 / 256.0, t);
+      double dev = fabs(got - expected);
+      if( dev > worst ) { worst = dev; worst_f = f_q8; worst_t = t; }
+      if( expected >= 100 && dev / expected > worst_rel ) {
+        worst_rel = dev / expected;
+        worst_rel_f = f_q8;
+        worst_rel_t = t;
+      }
+    }
+  }
+  printf("  worst deviation %.2f gpm at %.2f Hz, %d C\n", worst, worst_f / 256.0, worst_t);
+  printf("  worst relative, 100 gpm and up: %.4f%% at %.2f Hz, %d C (rounding is 0.5 gpm)\n",
+         100 * worst_rel, worst_rel_f / 256.0, worst_rel_t);
+
+  // the clamps
+  int at_max = flow_lookup(4992 << 8, 23);
+  if( flow_lookup(6000 << 8, 23) != at_max || flow_lookup(-256, 23) != 0 ||
+      flow_lookup(1000 << 8, -60) != flow_lookup(1000 << 8, FLOW_TABLE_TMIN) ||
+      flow_lookup(1000 << 8, 200) != flow_lookup(1000 << 8, 128) ) {
+    printf("FAILED: out of range inputs not clamped\n");
+    failed++;
+  }
+  printf("  1000 Hz at 23 C: %d gpm, model %.2f gpm\n",
+         flow_lookup(1000 << 8, 23), model_flow(1000, 23));
+
+  if( worst > MAX_DEV_GPM ) {
+    printf("FAILED: over %.1f gpm from the model\n", MAX_DEV_GPM);
+    failed++;
+  }
+  printf(failed ? "Failed\n\n" : "Passed\n\n");
+  return failed;
+}
+
+// flow_lookup against calc_flow, the build without VORTEX_FLOW_TABLE,
+// from 0 past FLOW_FREQ_MAX.  Up to the last column they agree within
+// MAX_CALC_DIFF_GPM; above it flow_lookup holds its 4992 Hz value while
+// calc_flow keeps rising to FLOW_FREQ_MAX and holds there.
+int test_vs_calc_flow(void) {
+  const int f_edge = (FLOW_TABLE_COLS - 1) << FLOW_TABLE_FSHIFT;
+  int worst = 0, worst_f = 0, worst_t = 0;
+  int failed = 0;
+
+  printf("TEST: flow_lookup vs calc_flow, 0 to %d Hz, -40 to 125 C\n", FLOW_FREQ_MAX + 1000);
+  printf("------------------------------------------------------------------------\n");
+  for( int t=-40; t<=125; t+=5 ) {
+    int at_edge = flow_lookup(f_edge << 8, t);
+    int at_max = calc_flow(FLOW_FREQ_MAX, t);
+    for( int f=0; f<=FLOW_FREQ_MAX + 1000; f++ ) {
+      int got = flow_lookup(f << 8, t);
+      int calc = calc_flow(f, t);
+      if( f <= f_edge ) {
+        int diff = abs(got - calc);
+        if( diff > worst ) { worst = diff; worst_f = f; worst_t = t; }
+        continue;
+      }
+      if( got != at_edge || calc < got ||
+          (f >= FLOW_FREQ_MAX && calc != at_max) ) {
+        printf("FAILED: %d Hz, %d C: lookup %d (edge %d), calc_flow %d (max %d)\n",
+               f, t, got, at_edge, calc, at_max);
+        if( ++failed > 10 ) { return failed; }
+      }
+    }
+  }
+  printf("  worst difference up to %d Hz: %d gpm at %d Hz, %d C\n",
+         f_edge, worst, worst_f, worst_t);
+  printf("  at 23 C: lookup holds %d gpm above %d Hz, calc_flow reaches %d gpm at %d Hz\n",
+         flow_lookup(f_edge << 8, 23), f_edge, calc_flow(FLOW_FREQ_MAX, 23), FLOW_FREQ_MAX);
+  if( worst > MAX_CALC_DIFF_GPM ) {
+    printf("FAILED: over %d gpm apart below the table edge\n", MAX_CALC_DIFF_GPM);
+    failed++;
+  }
+  printf(failed ? "Failed\n\n" : "Passed\n\n");
+  return failed;
+}
+
+// where calc_flow's own constants put it
+void show_calc_flow(void) {
+  static const int freqs[] = { 10, 100, 1000, 3000 };
+  static const int temps[] = { 0, 23, 60 };
+
+  printf("calc_flow and flow_lookup against the model:\n");
+  printf("  %6s %4s %10s %10s %10s\n", "Hz", "C", "model", "calc_flow", "lookup");
+  for( unsigned i=0; i<sizeof(freqs)/sizeof(freqs[0]); i++ ) {
+    for( unsigned j=0; j<sizeof(temps)/sizeof(temps[0]); j++ ) {
+      int f = freqs[i], t = temps[j];
+      printf("  %6d %4d %10.2f %10d %10d\n", f, t, model_flow(f, t),
+             calc_flow(f, t), flow_lookup(f << 8, t));
+    }
+  }
+  printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+  int failed = 0;
+
+  failed += test_surface();
+  failed += test_vs_calc_flow();
+  show_calc_flow();
+
+  // host time per call over the same inputs
+  static int fs[1024], ts[1024];
+  srand(5003);
+  for( int i=0; i<1024; i++ ) {
+    fs[i] = 50 + rand() % 3000;
+    ts[i] = rand() % 60;
+  }
+  int (* volatile calc_fn)(int, int) = &calc_flow;
+  int (* volatile lookup_fn)(int, int) = &flow_lookup;
+  const int reps = 100;
+  int sum = 0;
+  double t_start = now_ns();
+#ifdef HAVE_TSC
+  unsigned long long c_start = __rdtsc();
+#endif
+  for( int r=0; r<reps; r++ ) {
+    for( int i=0; i<1024; i++ ) { sum += calc_fn(fs[i], ts[i]); }
+  }
+  double ns_calc = (now_ns() - t_start) / reps / 1024;
+#ifdef HAVE_TSC
+  double cyc_calc = (double) (__rdtsc() - c_start) / reps / 1024;
+  c_start = __rdtsc();
+#endif
+  t_start = now_ns();
+  for( int r=0; r<reps; r++ ) {
+    for( int i=0; i<1024; i++ ) { sum += lookup_fn(fs[i] << 8, ts[i]); }
+  }
+  double ns_lookup = (now_ns() - t_start) / reps / 1024;
+#ifdef HAVE_TSC
+  double cyc_lookup = (double) (__rdtsc() - c_start) / reps / 1024;
+  printf("host time per call: calc_flow %.1f ns (%.0f TSC cycles), flow_lookup %.1f ns "
+         "(%.0f TSC cycles), %.0fx (%d)\n", ns_calc, cyc_calc, ns_lookup, cyc_lookup,
+         ns_calc / ns_lookup, sum);
+#else
+  printf("host time per call: calc_flow %.1f ns, flow_lookup %.1f ns, %.0fx (%d)\n",
+         ns_calc, ns_lookup, ns_calc / ns_lookup, sum);
+#endif
+  printf("tables: %d x (%d + %d) entries, %d bytes of flash\n", FLOW_TABLE_ROWS,
+         FLOW_TABLE_COLS, FLOW_TABLE_LO_COLS, (int) (sizeof(flow_table) + sizeof(flow_table_lo)));
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,207 @@
+// Host build of the Goertzel frequency tracker in goertzel.cpp.
+//
+// Checked against the FFT peak that m4/plot_data.m finds for
+// data_1000Hz_1105gpm.txt, and against synthetic tones: off-bin sines,
+// strong harmonics and noise that upset the zero-crossing detector, a
+// frequency step, loss of signal, and the hand-over between the tracker
+// and the crossing estimator in goertzel_track.
+//
+// usage: test_goertzel [data file]   default ../data_1000Hz_1105gpm.txt
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../flowmeter/flow_calc.h"
+#include "../flowmeter/goertzel.h"
+
+#define MAX_SAMPLES 4096
+
+// one hex sample per line, as written by the data logger
+int load_samples(const char *path, unsigned short *vals, int max) {
+  FILE *f = fopen(path, "r");
+  unsigned int v;
+  int n = 0;
+
+  if( !f ) {
+    printf("Can't open %s\n", path);
+    return -1;
+  }
+  while( n < max && fscanf(f, "%x", &v) == 1 ) {
+    vals[n++] = (unsigned short) v;
+  }
+  fclose(f);
+  return n;
+}
+
+// what plot_data.m does: the strongest FFT bin above DC, in Hz
+double fft_fundamental(unsigned short *vals, int n) {
+  double best = 0;
+  int best_k = 0;
+
+  for( int k=1; k<=n/2; k++ ) {
+    double re = 0, im = 0;
+    for( int i=0; i<n; i++ ) {
+      re += vals[i] * cos(2 * M_PI * k * i / n);
+      im -= vals[i] * sin(2 * M_PI * k * i / n);
+    }
+    if( re*re + im*im > best ) {
+      best = re*re + im*im;
+      best_k = k;
+    }
+  }
+  return best_k * (double) GOERTZEL_FS / n;
+}
+
+// tone generator with continuous phase, optional 2nd/3rd harmonics and noise
+struct tone {
+  double f, amp, h2, h3, noise;
+  double phase;
+};
+
+unsigned short tone_sample(tone *t) {
+  double v = 0x8000 + t->amp * (sin(t->phase) + t->h2 * sin(2*t->phase)
+                                + t->h3 * sin(3*t->phase))
+             + t->noise * ((rand() % 2001) - 1000) / 1000.0;
+  t->phase += 2 * M_PI * t->f / GOERTZEL_FS;
+  if( v < 0 ) { v = 0; }
+  if( v > 65535 ) { v = 65535; }
+  return (unsigned short) v;
+}
+
+// seeds the tracker seed_err Hz off, runs blocks, checks the last estimate
+int test_tone(const char *name, tone t, double seed_err, int blocks, double max_err) {
+  int published = 0;
+
+  printf("TEST: goertzel, %s, %.2f Hz\n", name, t.f);
+  printf("------------------------------------------\n");
+  goertzel_reset(&goertzel);
+  goertzel_seed(&goertzel, (int) ((t.f + seed_err) * 256));
+  for( int i=0; i<blocks*GOERTZEL_BLOCK; i++ ) {
+    published += goertzel_sample(&goertzel, tone_sample(&t));
+  }
+  double err = fabs(goertzel.freq_q8 / 256.0 - t.f);
+  printf("  seeded at %+.1f Hz, after %d blocks: %.3f Hz (error %.3f Hz)\n",
+         seed_err, published, goertzel.freq_q8 / 256.0, err);
+  if( published != blocks || err > max_err ) {
+    printf("FAILED: error bound %.2f Hz\n\n", max_err);
+    return 1;
+  }
+  printf("Passed\n\n");
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  static unsigned short vals[MAX_SAMPLES];
+  const char *path = (argc > 1) ? argv[1] : "../data_1000Hz_1105gpm.txt";
+  int failed = 0;
+  int n;
+
+  // the captured data, seeded from the crossing count like the firmware
+  n = load_samples(path, vals, MAX_SAMPLES);
+  if( n < GOERTZEL_BLOCK ) { return 1; }
+  printf("TEST: goertzel vs plot_data.m FFT, %s\n", path);
+  printf("------------------------------------------\n");
+  double fft_f = fft_fundamental(vals, GOERTZEL_BLOCK);
+  calc_freq(vals, GOERTZEL_BLOCK);
+  goertzel_reset(&goertzel);
+  goertzel_seed(&goertzel, freq << 8);
+  for( int i=0; i<GOERTZEL_BLOCK; i++ ) {
+    goertzel_sample(&goertzel, vals[i]);
+  }
+  printf("  FFT fundamental %.1f Hz, crossings %d Hz, goertzel %.3f Hz\n",
+         fft_f, calc_freq(vals, GOERTZEL_BLOCK), goertzel.freq_q8 / 256.0);
+  if( fabs(goertzel.freq_q8 / 256.0 - fft_f) > 0.5 ) {
+    printf("FAILED: more than 0.5 Hz from the FFT\n");
+    failed++;
+  } else {
+    printf("Passed\n");
+  }
+  printf("\n");
+
+  srand(5003);
+  failed += test_tone("clean", tone{ 1234.56, 20000, 0, 0, 0, 0 }, 12, 3, 0.05);
+  // low tones: the mirror image at -f leaks into the bank and biases the
+  // interpolation slightly
+  failed += test_tone("clean", tone{ 87.3, 20000, 0, 0, 0, 0 }, -15, 3, 0.2);
+  failed += test_tone("clean", tone{ 3210.1, 20000, 0, 0, 0, 0 }, 8, 3, 0.05);
+  failed += test_tone("noisy", tone{ 1000.0, 10000, 0, 0, 8000, 0 }, 5, 3, 0.3);
+
+  // harmonics strong enough to add crossings: count them for comparison
+  tone h = { 700.3, 12000, 0.9, 0.6, 3000, 0 };
+  tone hc = h;
+  freq_reset(&vortex);
+  for( int i=0; i<2*VORTEX_INPUT_SIZE; i++ ) { freq_sample(&vortex, tone_sample(&hc)); }
+  printf("crossing estimator on the harmonic tone: %.2f Hz\n\n", freq_q8 / 256.0);
+  failed += test_tone("2nd+3rd harmonics", h, 10, 3, 0.3);
+
+  // frequency step of 30 Hz, three bins: followed within a few blocks
+  printf("TEST: goertzel, 1000 -> 1030 Hz step\n");
+  printf("------------------------------------------\n");
+  tone s = { 1000.0, 20000, 0, 0, 500, 0 };
+  goertzel_reset(&goertzel);
+  goertzel_seed(&goertzel, 1000 << 8);
+  for( int i=0; i<2*GOERTZEL_BLOCK; i++ ) { goertzel_sample(&goertzel, tone_sample(&s)); }
+  s.f = 1030.0;
+  for( int b=0; b<5; b++ ) {
+    for( int i=0; i<GOERTZEL_BLOCK; i++ ) { goertzel_sample(&goertzel, tone_sample(&s)); }
+    printf("  block %d: %.3f Hz\n", b, goertzel.freq_q8 / 256.0);
+  }
+  if( fabs(goertzel.freq_q8 / 256.0 - s.f) > 0.2 ) {
+    printf("FAILED: did not follow the step\n");
+    failed++;
+  } else {
+    printf("Passed\n");
+  }
+  printf("\n");
+
+  // flat input: lock is lost, so the firmware re-seeds from the crossings
+  printf("TEST: goertzel, loss of signal\n");
+  printf("------------------------------------------\n");
+  for( int i=0; i<GOERTZEL_BLOCK; i++ ) { goertzel_sample(&goertzel, 0x8000); }
+  if( goertzel.locked ) {
+    printf("FAILED: still locked on a flat input\n");
+    failed++;
+  } else {
+    printf("Passed\n");
+  }
+  printf("\n");
+
+  // the firmware's combination: only one estimator writes freq_q8
+  printf("TEST: goertzel_track, tracker and crossings publishing in turn\n");
+  printf("------------------------------------------\n");
+  tone c = { 1234.56, 20000, 0, 0, 500, 0 };
+  int wrong = 0, locked_updates = 0;
+  freq_reset(&vortex);
+  goertzel_reset(&goertzel);
+  for( int i=0; i<4*GOERTZEL_BLOCK; i++ ) {
+    int was_locked = goertzel.locked;
+    int published = freq_q8;
+    int updated = goertzel_track(&goertzel, &vortex, tone_sample(&c));
+    if( was_locked ) {
+      // the crossings ran but must not have overwritten the tracker
+      if( updated ? (freq_q8 != goertzel.freq_q8) : (freq_q8 != published) ) { wrong++; }
+      locked_updates += updated;
+    }
+  }
+  printf("  locked %d, %d tracker updates, %.3f Hz, crossings kept %.3f Hz\n",
+         goertzel.locked, locked_updates, freq_q8 / 256.0, vortex.freq_q8 / 256.0);
+  if( !goertzel.locked || locked_updates < 2 || wrong || fabs(freq_q8 / 256.0 - c.f) > 0.2 ) {
+    printf("FAILED: %d samples where the crossings overwrote the tracker\n", wrong);
+    failed++;
+  }
+  int unlocked_at = -1;
+  for( int i=0; i<2*GOERTZEL_BLOCK && unlocked_at < 0; i++ ) {
+    if( goertzel_track(&goertzel, &vortex, 0x8000) && !goertzel.locked ) { unlocked_at = i; }
+  }
+  printf("  flat input: unlocked after %d samples, %.3f Hz\n", unlocked_at + 1, freq_q8 / 256.0);
+  if( unlocked_at < 0 || freq_q8 != vortex.freq_q8 ) {
+    printf("FAILED: did not fall back to the crossings estimate\n");
+    failed++;
+  } else {
+    printf("Passed\n");
+  }
+  printf("\n");
+
+  return failed ? 1 : 0;
+}
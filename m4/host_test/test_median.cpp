@@ -0,0 +1,207 @@
+// Host build of the sliding median in median.cpp.
+//
+// The incremental median is checked against sorting every window, for each
+// width and for inputs with many equal values.  Then impulse noise is
+// injected into a vortex sine and the crossing estimate is compared with
+// and without the median ahead of it, behind both the moving average with
+// fixed thresholds and the default band-pass with tracking.  Ends with the
+// host time per sample against a full sort per sample.
+//
+// usage: test_median
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../flowmeter/flow_calc.h"
+#include "../flowmeter/median.h"
+#include "host_timing.h"
+
+#define TEST_SAMPLES 20000
+
+// median of vals[n-count .. n] by insertion sort, the reference
+unsigned short median_ref(const unsigned short *vals, int n, int width) {
+  unsigned short w[MEDIAN_MAX];
+  int count = (n + 1 < width) ? n + 1 : width;
+
+  for( int k=0; k<count; k++ ) {
+    unsigned short v = vals[n - k];
+    int i = k;
+    for( ; i>0 && w[i-1] > v; i-- ) { w[i] = w[i-1]; }
+    w[i] = v;
+  }
+  return w[(count - 1) / 2];
+}
+
+int test_against_sort(const char *name, const unsigned short *vals, int width) {
+  median_state ms;
+  int failed = 0;
+
+  median_reset(&ms, width);
+  printf("TEST: median_sample vs sort, width %d (%d), %s\n", width, ms.width, name);
+  printf("----------------------------------------------------\n");
+  for( int n=0; n<TEST_SAMPLES; n++ ) {
+    unsigned short got = median_sample(&ms, vals[n]);
+    unsigned short expected = median_ref(vals, n, ms.width);
+    if( got != expected ) {
+      printf("FAILED: sample %d, got 0x%04x, but expected 0x%04x\n", n, got, expected);
+      if( ++failed > 10 ) { break; }
+    }
+  }
+  if( failed ) {
+    printf("Failed %d\n\n", failed);
+  } else {
+    printf("Passed %d samples\n\n", TEST_SAMPLES);
+  }
+  return failed;
+}
+
+// vortex sine with spikes of 1 to max_len samples toward either rail, on
+// average one every 40 samples and never closer than 10 samples apart, so
+// a window never holds more than one run
+void spiky_sine(unsigned short *vals, int n, double f, double amp, int max_len) {
+  srand(5003);
+  for( int i=0; i<n; i++ ) {
+    double v = 0x8000 + amp * sin(2 * M_PI * f * i / 10000.0) + (rand() % 201) - 100;
+    vals[i] = (unsigned short) v;
+  }
+  for( int i=0; i+max_len<n; i++ ) {
+    if( rand() % 40 == 0 ) {
+      unsigned short spike = (rand() & 1) ? 0xffff : 0x0000;
+      int len = 1 + rand() % max_len;
+      for( int k=0; k<len; k++ ) { vals[i++] = spike; }
+      i += 10 - len;
+    }
+  }
+}
+
+// worst error over windows 2..n of freq_sample on vals, optionally
+// through the median first
+double spike_error(const unsigned short *vals, int n, double f, int default_path,
+                   int width, int period_mode) {
+  median_state ms;
+  double worst = 0;
+  int windows = 0;
+
+  freq_reset(&vortex);
+  if( !default_path ) {
+    vortex.band = 0;
+    vortex.tracking = 0;
+  }
+  vortex.period_mode = period_mode;
+  median_reset(&ms, width);
+  for( int i=0; i<n; i++ ) {
+    unsigned short v = width ? median_sample(&ms, vals[i]) : vals[i];
+    if( freq_sample(&vortex, v) ) {
+      double err = fabs(freq_q8 / 256.0 - f);
+      if( windows >= 2 && err > worst ) { worst = err; }
+      windows++;
+    }
+  }
+  return worst;
+}
+
+int test_spikes(double f, double amp, int max_len, int width) {
+  static unsigned short vals[TEST_SAMPLES];
+  static const char *path_name[] = { "moving average, fixed", "band-pass, tracking" };
+  int failed = 0;
+
+  printf("TEST: impulse noise up to %d samples, %.2f Hz sine of %.0f\n", max_len, f, amp);
+  printf("------------------------------------------------------------\n");
+  spiky_sine(vals, TEST_SAMPLES, f, amp, max_len);
+  printf("  %-22s %7s %22s %22s\n", "", "median", "counting", "period");
+  for( int path=0; path<2; path++ ) {
+    for( int w=0; w<=width; w+=width ) {
+      double count_err = spike_error(vals, TEST_SAMPLES, f, path, w, 0);
+      double period_err = spike_error(vals, TEST_SAMPLES, f, path, w, 1);
+      printf("  %-22s %7d %19.2f Hz %19.2f Hz\n", path_name[path], w, count_err, period_err);
+      if( w && (count_err > 10 || period_err > 1.0) ) {
+        failed++;
+      }
+    }
+  }
+  if( failed ) {
+    printf("FAILED: error bounds 10 Hz counting, 1 Hz period, with the median\n\n");
+  } else {
+    printf("Passed\n\n");
+  }
+  return failed;
+}
+
+// what the median replaces: copy the window and sort it every sample
+unsigned short median_full_sort(unsigned short *ring, int *head, int width,
+                                unsigned short sample) {
+  unsigned short w[MEDIAN_MAX];
+  ring[*head] = sample;
+  if( ++*head == width ) { *head = 0; }
+  memcpy(w, ring, width * sizeof(w[0]));
+  for( int k=1; k<width; k++ ) {
+    unsigned short v = w[k];
+    int i = k;
+    for( ; i>0 && w[i-1] > v; i-- ) { w[i] = w[i-1]; }
+    w[i] = v;
+  }
+  return w[width >> 1];
+}
+
+int main(int argc, char *argv[]) {
+  static unsigned short vals[TEST_SAMPLES];
+  int failed = 0;
+
+  srand(5003);
+  for( int i=0; i<TEST_SAMPLES; i++ ) { vals[i] = (unsigned short) rand(); }
+  for( int w=1; w<=MEDIAN_MAX+2; w++ ) {
+    failed += test_against_sort("random", vals, w);
+  }
+  for( int i=0; i<TEST_SAMPLES; i++ ) { vals[i] = (unsigned short) (rand() % 4); }
+  for( int w=3; w<=MEDIAN_MAX; w+=2 ) {
+    failed += test_against_sort("4 levels", vals, w);
+  }
+
+  // a median of w removes runs of up to (w-1)/2 spike samples, as long as
+  // a half period of the signal is well over w samples
+  failed += test_spikes(1000.0, 8000, 1, 3);
+  failed += test_spikes(412.3, 8000, 2, 5);
+  failed += test_spikes(180.0, 8000, 2, VORTEX_MEDIAN_WIDTH);
+  failed += test_spikes(87.3, 8000, 4, 9);
+
+  // host time per sample on a spiky sine
+  spiky_sine(vals, TEST_SAMPLES, 1234.56, 8000, 2);
+  for( int w=3; w<=MEDIAN_MAX; w+=2 ) {
+    unsigned short (* volatile inc)(median_state *, unsigned short) = &median_sample;
+    unsigned short (* volatile full)(unsigned short *, int *, int, unsigned short) = &median_full_sort;
+    unsigned short ring[MEDIAN_MAX] = { 0 };
+    median_state ms;
+    int head = 0;
+    unsigned int sum = 0;
+    const int reps = 50;
+
+    median_reset(&ms, w);
+    double t_start = now_ns();
+#ifdef HAVE_TSC
+    unsigned long long c_start = __rdtsc();
+#endif
+    for( int r=0; r<reps; r++ ) {
+      for( int i=0; i<TEST_SAMPLES; i++ ) { sum += inc(&ms, vals[i]); }
+    }
+    double ns_inc = (now_ns() - t_start) / reps / TEST_SAMPLES;
+#ifdef HAVE_TSC
+    double cyc_inc = (double) (__rdtsc() - c_start) / reps / TEST_SAMPLES;
+#endif
+    t_start = now_ns();
+    for( int r=0; r<reps; r++ ) {
+      for( int i=0; i<TEST_SAMPLES; i++ ) { sum += full(ring, &head, w, vals[i]); }
+    }
+    double ns_full = (now_ns() - t_start) / reps / TEST_SAMPLES;
+#ifdef HAVE_TSC
+    printf("host time per sample, width %d: incremental %.1f ns (%.0f TSC cycles), "
+           "sort per sample %.1f ns (%u)\n", w, ns_inc, cyc_inc, ns_full, sum);
+#else
+    printf("host time per sample, width %d: incremental %.1f ns, sort per sample %.1f ns (%u)\n",
+           w, ns_inc, ns_full, sum);
+#endif
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+// Host build of pow10 in math_funcs.cpp and the generated pow10_table.cpp.
+//
+// Every 1000x the table covers is swept against pow(10, x), and so is the
+// linear scan pow10 replaced, over the part of the range its table had.
+// pow10 must be at least 10x closer there and within MAX_REL everywhere.
+// Ends with the host time per call of both.
+//
+// usage: test_pow10
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../flowmeter/math_funcs.h"
+#include "host_timing.h"
+
+#define MAX_REL 8e-4  /* (0.032 ln 10)^2 / 8 of interpolation, and rounding */
+
+// pow10 as it was: a scan of 67 (1000x, 1000y) pairs, returning the y of
+// the last x below num, the reference
+const unsigned short pow10_scan_table[] = {
+  1220,16588, 1226,16820, 1232,17058, 1238,17301, 1244,17550, 1251,17806,
+  1257,18068, 1263,18337, 1270,18612, 1276,18894, 1283,19184, 1290,19481,
+  1296,19786, 1303,20099, 1310,20421, 1317,20751, 1324,21090, 1331,21438,
+  1338,21796, 1346,22164, 1353,22542, 1360,22931, 1368,23331, 1376,23742,
+  1383,24166, 1391,24602, 1399,25050, 1407,25513, 1415,25989, 1423,26480,
+  1431,26985, 1439,27507, 1448,28045, 1456,28600, 1465,29172, 1474,29764,
+  1483,30374, 1491,31004, 1500,31656, 1510,32329, 1519,33025, 1528,33745,
+  1538,34490, 1547,35261, 1557,36060, 1567,36886, 1577,37743, 1587,38631,
+  1597,39552, 1608,40507, 1618,41497, 1629,42526, 1639,43594, 1650,44704,
+  1661,45858, 1673,47058, 1684,48305, 1696,49604, 1707,50956, 1719,52365,
+  1731,53833, 1743,55364, 1756,56961, 1768,58628, 1781,60369, 1794,62187,
+  1807,64089,
+  0,0
+};
+
+int pow10_scan(int num) {
+  int i = 0;
+  int result=0;
+  for(i = 0; pow10_scan_table[i] != 0; i+=2) {
+    if ( pow10_scan_table[i] < num) {
+      result = pow10_scan_table[i+1];
+    }
+  }
+  return result;
+}
+
+// worst relative error against 1000 * 10^(num/1000) over lo..hi
+double sweep(int (*fn)(int), int lo, int hi, int *worst_num) {
+  double worst = 0;
+  for( int num=lo; num<=hi; num++ ) {
+    double expected = 1000 * pow(10, num / 1000.0);
+    double rel = fabs(fn(num) / expected - 1);
+    if( rel > worst ) { worst = rel; *worst_num = num; }
+  }
+  return worst;
+}
+
+int main(int argc, char *argv[]) {
+  const int lo = POW10_X0, hi = POW10_X0 + ((POW10_ENTRIES - 1) << POW10_SHIFT);
+  int failed = 0, at, at_scan;
+
+  printf("TEST: pow10 vs pow(10, x)\n");
+  printf("-------------------------\n");
+  double worst = sweep(&pow10, lo, hi, &at);
+  printf("  x = %.3f .. %.3f: worst %.2e relative at x = %.3f\n", lo / 1000.0, hi / 1000.0,
+         worst, at / 1000.0);
+  if( worst > MAX_REL ) {
+    printf("FAILED: over %.1e\n", MAX_REL);
+    failed++;
+  }
+  // the scan only returns from above its first x, 1.220
+  double worst_part = sweep(&pow10, 1221, 1807, &at);
+  double worst_scan = sweep(&pow10_scan, 1221, 1807, &at_scan);
+  printf("  x = 1.221 .. 1.807: worst %.2e relative at x = %.3f, the scan %.2e at x = %.3f, "
+         "%.0fx\n", worst_part, at / 1000.0, worst_scan, at_scan / 1000.0, worst_scan / worst_part);
+  if( worst_part * 10 > worst_scan ) {
+    printf("FAILED: not 10x closer than the scan\n");
+    failed++;
+  }
+  // clamped to the ends of the table, and the viscosity range in use
+  if( pow10(lo - 100) != pow10(lo) || pow10(hi + 100) != pow10(hi) ) {
+    printf("FAILED: x outside the table not clamped\n");
+    failed++;
+  }
+  int hot = 24780000 / (100 * 125 + 13315), cold = 24780000 / (100 * -40 + 13315);
+  printf("  -40..125 C needs x = %.3f .. %.3f\n", hot / 1000.0, cold / 1000.0);
+  if( hot < lo || cold > hi ) {
+    printf("FAILED: table does not cover -40..125 C\n");
+    failed++;
+  }
+  printf(failed ? "Failed\n\n" : "Passed\n\n");
+
+  // host time per call over the old table's range
+  static int nums[1024];
+  srand(5003);
+  for( int i=0; i<1024; i++ ) { nums[i] = 1221 + rand() % 587; }
+  int (* volatile scan_fn)(int) = &pow10_scan;
+  int (* volatile index_fn)(int) = &pow10;
+  const int reps = 1000;
+  unsigned int sum = 0;
+  double t_start = now_ns();
+#ifdef HAVE_TSC
+  unsigned long long c_start = __rdtsc();
+#endif
+  for( int r=0; r<reps; r++ ) {
+    for( int i=0; i<1024; i++ ) { sum += scan_fn(nums[i]); }
+  }
+  double ns_scan = (now_ns() - t_start) / reps / 1024;
+#ifdef HAVE_TSC
+  double cyc_scan = (double) (__rdtsc() - c_start) / reps / 1024;
+  c_start = __rdtsc();
+#endif
+  t_start = now_ns();
+  for( int r=0; r<reps; r++ ) {
+    for( int i=0; i<1024; i++ ) { sum += index_fn(nums[i]); }
+  }
+  double ns_index = (now_ns() - t_start) / reps / 1024;
+#ifdef HAVE_TSC
+  double cyc_index = (double) (__rdtsc() - c_start) / reps / 1024;
+  printf("host time per call: scan %.1f ns (%.0f TSC cycles), pow10 %.1f ns "
+         "(%.0f TSC cycles), %.0fx (%u)\n", ns_scan, cyc_scan, ns_index, cyc_index,
+         ns_scan / ns_index, sum);
+#else
+  printf("host time per call: scan %.1f ns, pow10 %.1f ns, %.0fx (%u)\n",
+         ns_scan, ns_index, ns_scan / ns_index, sum);
+#endif
+  printf("tables: scan %d bytes, pow10 %d bytes\n", (int) sizeof(pow10_scan_table),
+         (int) sizeof(pow10_table));
+
+  return failed ? 1 : 0;
+}
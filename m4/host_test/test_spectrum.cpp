@@ -0,0 +1,197 @@
+// Host build of the spectral frequency engine in spectrum.cpp.
+//
+// The in-place q15 real FFT is checked bin by bin against a double
+// precision DFT, from mixed tones and from full-scale sines, DC and the
+// worst-case growth of a stage that must not overflow; the frequency against the FFT peak that m4/plot_data.m
+// finds for data_1000Hz_1105gpm.txt and against off-bin tones, and the SNR
+// against clean and noisy input.  Ends with the host time per block.
+//
+// usage: test_spectrum [data file]   default ../data_1000Hz_1105gpm.txt
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../flowmeter/flow_calc.h"
+#include "../flowmeter/spectrum.h"
+#include "host_timing.h"
+
+#define MAX_SAMPLES 4096
+
+// one hex sample per line, as written by the data logger
+int load_samples(const char *path, unsigned short *vals, int max) {
+  FILE *f = fopen(path, "r");
+  unsigned int v;
+  int n = 0;
+
+  if( !f ) {
+    printf("Can't open %s\n", path);
+    return -1;
+  }
+  while( n < max && fscanf(f, "%x", &v) == 1 ) {
+    vals[n++] = (unsigned short) v;
+  }
+  fclose(f);
+  return n;
+}
+
+// what plot_data.m does: the strongest FFT bin above DC, in Hz
+double fft_fundamental(unsigned short *vals, int n) {
+  double best = 0;
+  int best_k = 0;
+
+  for( int k=1; k<=n/2; k++ ) {
+    double re = 0, im = 0;
+    for( int i=0; i<n; i++ ) {
+      re += vals[i] * cos(2 * M_PI * k * i / n);
+      im -= vals[i] * sin(2 * M_PI * k * i / n);
+    }
+    if( re*re + im*im > best ) {
+      best = re*re + im*im;
+      best_k = k;
+    }
+  }
+  return best_k * (double) FFT_FS / n;
+}
+
+// rfft_q15 against a double DFT of the same q15 input, over every bin
+// including DC and Nyquist, error relative to the largest bin
+int test_rfft(const char *name, const short *input) {
+  double worst = 0, peak = 0;
+  int exponent;
+
+  printf("TEST: rfft_q15 vs double DFT, %s\n", name);
+  printf("----------------------------------------------\n");
+  for( int i=0; i<FFT_SIZE; i++ ) { fft_buf[i] = input[i]; }
+  exponent = rfft_q15(fft_buf);
+  for( int k=0; k<=FFT_SIZE/2; k++ ) {
+    double re = 0, im = 0, got_re, got_im;
+    for( int i=0; i<FFT_SIZE; i++ ) {
+      re += input[i] * cos(2 * M_PI * k * i / FFT_SIZE);
+      im -= input[i] * sin(2 * M_PI * k * i / FFT_SIZE);
+    }
+    if( k == 0 || k == FFT_SIZE/2 ) {
+      got_re = fft_buf[k ? 1 : 0];  // both real, packed in bin 0
+      got_im = 0;
+    } else {
+      got_re = fft_buf[2*k];
+      got_im = fft_buf[2*k+1];
+    }
+    double err = hypot(got_re * ldexp(1, exponent) - re, got_im * ldexp(1, exponent) - im);
+    if( err > worst ) { worst = err; }
+    if( hypot(re, im) > peak ) { peak = hypot(re, im); }
+  }
+  printf("  exponent %d, worst bin error %.2e of the peak\n", exponent, worst / peak);
+  if( worst / peak > 2e-3 ) {
+    printf("FAILED: error bound 2e-3\n\n");
+    return 1;
+  }
+  printf("Passed\n\n");
+  return 0;
+}
+
+int test_rfft_inputs(void) {
+  static short input[FFT_SIZE];
+  int failed = 0;
+
+  srand(5003);
+  for( int i=0; i<FFT_SIZE; i++ ) {
+    input[i] = (short) (12000 * sin(2 * M_PI * 101.3 * i / FFT_SIZE)
+                        + 6000 * cos(2 * M_PI * 17 * i / FFT_SIZE)
+                        + (rand() % 4001) - 2000);
+  }
+  failed += test_rfft("two tones and noise", input);
+
+  // full scale, where a single halving per stage is not enough
+  for( int i=0; i<FFT_SIZE; i++ ) {
+    input[i] = (short) lround(32767 * sin(2 * M_PI * 64 * i / FFT_SIZE));
+  }
+  failed += test_rfft("full-scale sine on bin 64", input);
+  for( int i=0; i<FFT_SIZE; i++ ) {
+    input[i] = (short) lround(32767 * cos(2 * M_PI * 101.3 * i / FFT_SIZE));
+  }
+  failed += test_rfft("full-scale sine between bins", input);
+  for( int i=0; i<FFT_SIZE; i++ ) { input[i] = 32767; }
+  failed += test_rfft("DC +32767", input);
+
+  // the worst case of a stage, |a +/- w b| = (1 + sqrt 2) max: eight
+  // complex points, placed at their bit-reversed positions, that the
+  // first two stages turn into a = (30000, 0), b = (30000, 30000) for the
+  // 45 degree twiddle of the third.  One halving leaves 36213 there.
+  static const int worst_points[8][2] = {
+    { 30000, 0 }, { -30000, 0 }, { 0, 30000 }, { 0, -30000 },
+    { 30000, 30000 }, { -30000, -30000 }, { -30000, 30000 }, { 30000, -30000 },
+  };
+  for( int i=0; i<FFT_SIZE; i++ ) { input[i] = 0; }
+  for( int j=0; j<8; j++ ) {
+    int r = 0;
+    for( int bit=1; bit<FFT_SIZE/2; bit<<=1 ) { r = (r << 1) | ((j & bit) != 0); }
+    input[2*r] = (short) worst_points[j][0];
+    input[2*r+1] = (short) worst_points[j][1];
+  }
+  failed += test_rfft("worst-case stage growth", input);
+  for( int i=0; i<FFT_SIZE; i++ ) { input[i] = -32768; }
+  failed += test_rfft("DC -32768", input);
+  return failed;
+}
+
+int test_tone(double f, double amp, double noise, double max_err, int min_snr, int max_snr) {
+  static unsigned short vals[FFT_SIZE];
+
+  printf("TEST: calc_freq_fft, %.2f Hz, noise %.0f\n", f, noise);
+  printf("--------------------------------------\n");
+  for( int i=0; i<FFT_SIZE; i++ ) {
+    vals[i] = (unsigned short) (0x8000 + amp * sin(2 * M_PI * f * i / FFT_FS + 0.3)
+                                + noise * ((rand() % 2001) - 1000) / 1000.0);
+  }
+  calc_freq_fft(vals, FFT_SIZE);
+  double err = fabs(freq_q8 / 256.0 - f);
+  printf("  %.3f Hz (error %.3f Hz), SNR %d dB\n", freq_q8 / 256.0, err, freq_snr_db);
+  if( err > max_err || freq_snr_db < min_snr || freq_snr_db > max_snr ) {
+    printf("FAILED: error bound %.2f Hz, SNR %d..%d dB\n\n", max_err, min_snr, max_snr);
+    return 1;
+  }
+  printf("Passed\n\n");
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  static unsigned short vals[MAX_SAMPLES];
+  const char *path = (argc > 1) ? argv[1] : "../data_1000Hz_1105gpm.txt";
+  int failed = 0;
+  int n;
+
+  failed += test_rfft_inputs();
+
+  n = load_samples(path, vals, MAX_SAMPLES);
+  if( n < 0 ) { return 1; }
+  printf("TEST: calc_freq_fft vs plot_data.m FFT, %s\n", path);
+  printf("----------------------------------------------\n");
+  double fft_f = fft_fundamental(vals, n);
+  calc_freq_fft(vals, n);
+  printf("  FFT fundamental %.1f Hz (%.0f Hz bins), calc_freq_fft %.3f Hz, SNR %d dB\n",
+         fft_f, (double) FFT_FS / n, freq_q8 / 256.0, freq_snr_db);
+  if( fabs(freq_q8 / 256.0 - fft_f) > 0.5 * FFT_FS / n ) {
+    printf("FAILED: more than half an Octave bin from the FFT\n");
+    failed++;
+  } else {
+    printf("Passed\n");
+  }
+  printf("\n");
+
+  failed += test_tone(1000.0, 20000, 0, 0.1, 40, 99);
+  failed += test_tone(1234.56, 20000, 0, 0.1, 40, 99);
+  failed += test_tone(87.3, 20000, 0, 0.1, 40, 99);
+  failed += test_tone(3210.1, 20000, 0, 0.1, 40, 99);
+  // uniform noise of +/-20000 against a 5000 sine: -10.3 dB
+  failed += test_tone(1234.56, 5000, 20000, 2.0, -13, -8);
+
+  // host time per block, same input each time
+  int sum = 0;
+  double t_start = now_ns();
+  for( int r=0; r<1000; r++ ) { sum += calc_freq_fft(vals, FFT_SIZE); }
+  printf("host time per %d sample block: %.1f us (%d)\n",
+         FFT_SIZE, (now_ns() - t_start) / 1000 / 1000, sum);
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+// Host build of the firmware square roots, checked against sqrt_trunc from
+// the Module 1 harness.
+//
+// usage: test_sqrt_funcs [all]   "all" checks every 32-bit input
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "../../m1/sqrt_c/sqrt_trunc.c"
+#include "../../m1/sqrt_c/sqrt64_trunc.c"
+#include "../flowmeter/sqrt_funcs.h"
+#include "host_timing.h"
+
+int DEBUG=0;
+
+int test_sqrt_clz(uint64_t stride) {
+  int failed = 0;
+  uint64_t count = 0;
+
+  printf("TEST: sqrt_clz vs sqrt_trunc, stride %llu\n", (unsigned long long) stride);
+  printf("-------------------------------------------\n");
+  for( uint64_t n = 0; n <= 0xffffffffULL; n += (n < (1 << 24)) ? 1 : stride ) {
+    uint32_t expected = sqrt_trunc((uint32_t) n);
+    uint32_t got = sqrt_clz((uint32_t) n);
+    count++;
+    if( got != expected ) {
+      printf("FAILED: sqrt_clz(%u), got %u, but expected %u\n", (uint32_t) n, got, expected);
+      if( ++failed > 10 ) { break; }
+    }
+  }
+  // top of the range, where the root estimate is clamped
+  for( uint32_t k = 0; k < (1 << 16); k++ ) {
+    uint32_t n = 0xffffffffU - k;
+    count++;
+    if( sqrt_clz(n) != sqrt_trunc(n) ) {
+      printf("FAILED: sqrt_clz(%u), got %u, but expected %u\n", n, sqrt_clz(n), sqrt_trunc(n));
+      failed++;
+    }
+  }
+  if(failed) {
+    printf("Failed %d/%llu\n", failed, (unsigned long long) count);
+  } else {
+    printf("Passed %llu tests\n", (unsigned long long) count);
+  }
+  printf("\n");
+  return failed;
+}
+
+// sweeps num geometrically over [1, 2^32), and densely over the Reynolds
+// range, reporting the worst relative error against double precision
+int test_rsqrt_q31(void) {
+  int failed = 0;
+  double worst_re = 0, worst_all = 0;
+  uint32_t worst_re_at = 0, worst_all_at = 0;
+  uint64_t count = 0;
+
+  printf("TEST: rsqrt_q31 vs 1/sqrt() in double\n");
+  printf("-------------------------------------\n");
+  for( double x = 1; x < 4294967296.0; x = (x < 1e5 || x > 1e7) ? x*1.0001 + 1 : x + 7 ) {
+    uint32_t n = (uint32_t) x;
+    double expected = 1.0 / sqrt((double) n);
+    double err = fabs(rsqrt_q31(n) / 2147483648.0 - expected) / expected;
+    count++;
+    if( n <= 10000000 && err > worst_re ) { worst_re = err; worst_re_at = n; }
+    if( err > worst_all ) { worst_all = err; worst_all_at = n; }
+  }
+  printf("  worst relative error, num <= 10^7: %.2e at %u\n", worst_re, worst_re_at);
+  printf("  worst relative error, num < 2^32:  %.2e at %u\n", worst_all, worst_all_at);
+
+  // the bounds documented in sqrt_funcs.cpp
+  if( worst_re > 2e-6 ) {
+    printf("FAILED: error bound 2e-6 for num <= 10^7\n");
+    failed++;
+  }
+  if( worst_all > 4e-5 ) {
+    printf("FAILED: error bound 4e-5 for num < 2^32\n");
+    failed++;
+  }
+  if( rsqrt_q31(0) != 0xffffffff ) {
+    printf("FAILED: rsqrt_q31(0) = %u, expected saturation\n", rsqrt_q31(0));
+    failed++;
+  }
+  if(failed) {
+    printf("Failed %d checks\n", failed);
+  } else {
+    printf("Passed %llu inputs\n", (unsigned long long) count);
+  }
+  printf("\n");
+  return failed;
+}
+
+volatile uint32_t sink;
+
+// sqrt_q16 against the exact floor(sqrt(x * 2^16)) from sqrt64_trunc, dense
+// below 16.0 then strided over the rest of the Q16.16 range.  Also reports
+// how far sqrtf is from exact (it only has a 24-bit mantissa, so up to about
+// 1 LSB at the top of the range) and the throughput of both.
+int test_sqrt_q16(uint64_t stride) {
+  int failed = 0;
+  uint64_t count = 0;
+  double worst_f = 0;
+  uint32_t worst_f_at = 0;
+
+  printf("TEST: sqrt_q16 vs floor(sqrt(x * 2^16)), stride %llu\n", (unsigned long long) stride);
+  printf("---------------------------------------------------\n");
+  for( uint64_t n = 0; n <= 0xffffffffULL; n += (n < (1 << 20)) ? 1 : stride ) {
+    uint32_t expected = sqrt64_trunc(n << 16);
+    uint32_t got = sqrt_q16((uint32_t) n);
+    double exact = sqrt((double) n) * 256.0;
+    double err_f = fabs(sqrtf((float) n / 65536.0f) * 65536.0 - exact);
+    count++;
+    if( got != expected ) {
+      printf("FAILED: sqrt_q16(0x%08x), got 0x%08x, but expected 0x%08x\n",
+             (uint32_t) n, got, expected);
+      if( ++failed > 10 ) { break; }
+    }
+    if( err_f > worst_f ) { worst_f = err_f; worst_f_at = (uint32_t) n; }
+  }
+  printf("  sqrt_q16 error: < 1 LSB (truncated), sqrtf error: %.2f LSB at 0x%08x\n",
+         worst_f, worst_f_at);
+
+  // throughput over the whole range, same inputs for both
+  static uint32_t inputs[1 << 16];
+  uint32_t x = 2463534242U, total = 0;
+  for( int i=0; i<(1 << 16); i++ ) {
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    inputs[i] = x;
+  }
+  double t_start = now_ns();
+  for( int r=0; r<64; r++ ) {
+    for( int i=0; i<(1 << 16); i++ ) { total += sqrt_q16(inputs[i]); }
+  }
+  double ns_q16 = (now_ns() - t_start) / (64 << 16);
+  t_start = now_ns();
+  for( int r=0; r<64; r++ ) {
+    for( int i=0; i<(1 << 16); i++ ) {
+      total += (uint32_t) (sqrtf((float) inputs[i] / 65536.0f) * 65536.0f);
+    }
+  }
+  double ns_f = (now_ns() - t_start) / (64 << 16);
+  sink = total;
+  printf("  host throughput: sqrt_q16 %.2f ns/call, sqrtf %.2f ns/call\n", ns_q16, ns_f);
+
+  if(failed) {
+    printf("Failed %d/%llu\n", failed, (unsigned long long) count);
+  } else {
+    printf("Passed %llu tests\n", (unsigned long long) count);
+  }
+  printf("\n");
+  return failed;
+}
+
+// the other table sizes selectable with SQRT_SEED_BITS / RSQRT_SEED_BITS,
+// sampled: every input below 2^20, then a prime stride
+struct table_size {
+  unsigned bits;
+  unsigned int (*sqrt_func)(unsigned int);
+  unsigned int (*rsqrt_func)(unsigned int);
+  unsigned sqrt_entries, rsqrt_entries, newton_steps;
+};
+
+#define TABLE_SIZE(b) { b, &sqrt_clz_t<b>, &rsqrt_q31_t<b>, \
+  sqrt_seed_entries(b), rsqrt_seed_entries(b), rsqrt_newton_steps(b) }
+
+table_size table_sizes[] = {
+  TABLE_SIZE(5),
+  TABLE_SIZE(6),
+  TABLE_SIZE(7),
+  TABLE_SIZE(8),
+  TABLE_SIZE(10),
+  { 0, NULL, NULL, 0, 0, 0 } // terminator
+};
+
+int test_table_sizes(void) {
+  int failed = 0;
+
+  printf("TEST: seed table sizes\n");
+  printf("----------------------\n");
+  for( table_size *ts = table_sizes; ts->bits; ts++ ) {
+    int size_failed = 0;
+    double worst = 0;
+    for( uint64_t n = 0; n <= 0xffffffffULL; n += (n < (1 << 20)) ? 1 : 9973 ) {
+      uint32_t expected = sqrt_trunc((uint32_t) n);
+      uint32_t got = ts->sqrt_func((uint32_t) n);
+      if( got != expected ) {
+        printf("FAILED: sqrt_clz_t<%u>(%u), got %u, but expected %u\n",
+               ts->bits, (uint32_t) n, got, expected);
+        if( ++size_failed > 10 ) { break; }
+      }
+    }
+    for( double x = 1; x <= 10000000; x = x*1.001 + 1 ) {
+      uint32_t n = (uint32_t) x;
+      double expected = 1.0 / sqrt((double) n);
+      double err = fabs(ts->rsqrt_func(n) / 2147483648.0 - expected) / expected;
+      if( err > worst ) { worst = err; }
+    }
+    if( worst > 2e-6 ) {
+      printf("FAILED: rsqrt_q31_t<%u> error %.2e over bound 2e-6\n", ts->bits, worst);
+      size_failed++;
+    }
+    printf("  %2u bits: sqrt table %4u entries, rsqrt table %4u entries, "
+           "%u Newton steps, rsqrt error %.2e\n", ts->bits, ts->sqrt_entries, ts->rsqrt_entries, ts->newton_steps, worst);
+    failed += size_failed;
+  }
+  if(failed) {
+    printf("Failed %d\n", failed);
+  } else {
+    printf("Passed\n");
+  }
+  printf("\n");
+  return failed;
+}
+
+int main(int argc, char *argv[]) {
+  int all = (argc > 1) && !strcmp(argv[1], "all");
+  int failed = 0;
+
+  failed += test_sqrt_clz(all ? 1 : 997);
+  failed += test_rsqrt_q31();
+  failed += test_sqrt_q16(all ? 1 : 997);
+  failed += test_table_sizes();
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+// Runs the hand-written Cortex-M0+ assembly in the Thumb simulator, checks
+// it against the C reference and reports M0+ cycle counts.
+//
+// usage: test_thumb [object]   default thumb_asm.o
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "thumb_sim.h"
+#include "../../m1/sqrt_c/sqrt_trunc.c"
+
+int DEBUG=0;
+
+#define MAX_CYCLES 100000
+
+static thumb_cpu cpu;
+
+// AAPCS: r4-r11 and sp must survive a call
+static int check_preserved(const char *name) {
+  for( int i=4; i<12; i++ ) {
+    if( cpu.r[i] != 0x04040404U * i ) {
+      printf("FAILED: %s clobbers callee-saved r%d\n", name, i);
+      return 1;
+    }
+  }
+  if( cpu.r[13] != THUMB_RAM_BASE + THUMB_RAM_SIZE ) {
+    printf("FAILED: %s does not restore sp\n", name);
+    return 1;
+  }
+  return 0;
+}
+
+static int check_fault(const char *name, uint32_t input) {
+  if( cpu.fault ) {
+    printf("FAILED: %s(%u) faulted at 0x%08x: %s\n", name, input, cpu.fault_pc, cpu.fault);
+    return 1;
+  }
+  return 0;
+}
+
+// sqrt from math_funcs.cpp against sqrt_trunc, with cycle counts per decade
+int test_sqrt_asm(const char *name) {
+  uint32_t addr = thumb_symbol_addr(&cpu, name);
+  int failed = 0;
+  uint32_t input, got;
+
+  printf("TEST: %s (thumb) vs sqrt_trunc\n", name);
+  printf("-------------------------------\n");
+  if( !addr ) {
+    printf("FAILED: %s not found\n\n", name);
+    return 1;
+  }
+
+  printf("  %-22s %6s %8s %6s\n", "input range", "min", "mean", "max");
+  uint64_t lo = 0, hi = 10;
+  for( int decade = 0; decade < 10; decade++ ) {
+    uint64_t min = UINT64_MAX, max = 0, total = 0, count = 0;
+    uint64_t step = (hi - lo) / 10000 + 1;
+    if( hi > 0xffffffffULL ) { hi = 0x100000000ULL; }
+    for( uint64_t n = lo; n < hi && !failed; n += step ) {
+      input = (uint32_t) n;
+      got = thumb_call(&cpu, addr, 1, &input, MAX_CYCLES);
+      failed += check_fault(name, input);
+      if( !failed && got != sqrt_trunc(input) ) {
+        printf("FAILED: %s(%u), got %u, but expected %u\n", name, input, got, sqrt_trunc(input));
+        failed++;
+      }
+      if( !failed && check_preserved(name) ) { failed++; }
+      if( cpu.cycles < min ) { min = cpu.cycles; }
+      if( cpu.cycles > max ) { max = cpu.cycles; }
+      total += cpu.cycles;
+      count++;
+    }
+    printf("  [%10llu, %10llu) %6llu %8.1f %6llu\n", (unsigned long long) lo,
+           (unsigned long long) hi, (unsigned long long) min, (double) total / count,
+           (unsigned long long) max);
+    lo = hi;
+    hi *= 10;
+  }
+
+  // edges of the 32-bit range
+  uint32_t edges[] = { 0, 1, 2, 3, 4, 4294836224U, 4294836225U, 4294967295U };
+  for( unsigned i=0; i<sizeof(edges)/sizeof(edges[0]) && !failed; i++ ) {
+    got = thumb_call(&cpu, addr, 1, &edges[i], MAX_CYCLES);
+    failed += check_fault(name, edges[i]);
+    if( !failed && got != sqrt_trunc(edges[i]) ) {
+      printf("FAILED: %s(%u), got %u, but expected %u\n", name, edges[i], got, sqrt_trunc(edges[i]));
+      failed++;
+    }
+  }
+
+  if( !failed ) {
+    printf("Passed\n");
+  }
+  printf("\n");
+  return failed;
+}
+
+// r0() from monitor.cpp returns its own r0
+int test_get_r0(void) {
+  uint32_t addr = thumb_symbol_addr(&cpu, "get_r0");
+  uint32_t input = 0x5003cafe;
+  int failed = 0;
+
+  printf("TEST: get_r0 (thumb)\n");
+  printf("--------------------\n");
+  if( thumb_call(&cpu, addr, 1, &input, MAX_CYCLES) != input || cpu.fault ) {
+    printf("FAILED: get_r0 did not return r0\n");
+    failed++;
+  }
+  failed += check_preserved("get_r0");
+  printf("%s, %llu cycles\n\n", failed ? "Failed" : "Passed", (unsigned long long) cpu.cycles);
+  return failed;
+}
+
+// get_regs() from monitor.cpp stores r1-r15 at r0
+int test_get_regs(void) {
+  uint32_t addr = thumb_symbol_addr(&cpu, "get_regs");
+  uint32_t buf = THUMB_RAM_BASE + 0x100;
+  uint32_t sp = THUMB_RAM_BASE + THUMB_RAM_SIZE;
+  int failed = 0;
+
+  printf("TEST: get_regs (thumb)\n");
+  printf("----------------------\n");
+  thumb_call(&cpu, addr, 1, &buf, MAX_CYCLES);
+  failed += check_fault("get_regs", buf);
+  for( int i=1; i<=15 && !failed; i++ ) {
+    uint32_t expected = (i < 13) ? 0x04040404U * i
+                      : (i == 13) ? sp
+                      : (i == 14) ? (THUMB_RETURN | 1)
+                      : addr + 30 + 4;  // mov r1, r15 is the 16th instruction
+    uint32_t got = thumb_read32(&cpu, buf + 4*(i-1));
+    if( got != expected ) {
+      printf("FAILED: r%d stored as 0x%08x, expected 0x%08x\n", i, got, expected);
+      failed++;
+    }
+  }
+  failed += check_preserved("get_regs");
+  printf("%s, %llu cycles\n\n", failed ? "Failed" : "Passed", (unsigned long long) cpu.cycles);
+  return failed;
+}
+
+// get_sp() from monitor.cpp returns the stack pointer
+int test_get_sp(void) {
+  uint32_t addr = thumb_symbol_addr(&cpu, "get_sp");
+  int failed = 0;
+
+  printf("TEST: get_sp (thumb)\n");
+  printf("--------------------\n");
+  if( thumb_call(&cpu, addr, 0, NULL, MAX_CYCLES) != THUMB_RAM_BASE + THUMB_RAM_SIZE || cpu.fault ) {
+    printf("FAILED: get_sp did not return sp\n");
+    failed++;
+  }
+  printf("%s, %llu cycles\n\n", failed ? "Failed" : "Passed", (unsigned long long) cpu.cycles);
+  return failed;
+}
+
+int main(int argc, char *argv[]) {
+  const char *path = (argc > 1) ? argv[1] : "thumb_asm.o";
+  int failed = 0;
+
+  if( thumb_load_elf(&cpu, path) ) {
+    return 1;
+  }
+  failed += test_sqrt_asm("sqrt");
+  failed += test_sqrt_asm("my_sqrt");
+  failed += test_get_r0();
+  failed += test_get_regs();
+  failed += test_get_sp();
+  return failed ? 1 : 0;
+}
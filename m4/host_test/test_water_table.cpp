@@ -0,0 +1,53 @@
+// Host build of the generated water_table.cpp.
+//
+// Every entry is checked against the double precision formulas it was
+// generated from, density (9) and viscosity (10) in flow_model.h.  Each
+// must be within half an LSB of its Q format, density must peak at 4 C
+// and viscosity must fall as temperature rises.
+//
+// usage: test_water_table
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../flowmeter/water_table.h"
+#include "flow_model.h"
+
+int main(int argc, char *argv[]) {
+  double worst_rho = 0, worst_mu = 0;
+  int worst_rho_t = 0, worst_mu_t = 0, peak = 0, failed = 0;
+
+  printf("TEST: water_density and water_viscosity vs the formulas, %d to %d C\n",
+         WATER_TABLE_TMIN, WATER_TABLE_TMIN + WATER_TABLE_ROWS - 1);
+  printf("-------------------------------------------------------------------\n");
+  for( int i=0; i<WATER_TABLE_ROWS; i++ ) {
+    int t = WATER_TABLE_TMIN + i;
+    double rho = water_density[i] / 64.0;
+    double mu = water_viscosity[i] / 65536.0;
+    double rho_err = fabs(rho - model_density(t)) * 64;
+    double mu_err = fabs(mu - 1000 * model_viscosity(t)) * 65536;
+    if( rho_err > worst_rho ) { worst_rho = rho_err; worst_rho_t = t; }
+    if( mu_err > worst_mu ) { worst_mu = mu_err; worst_mu_t = t; }
+    if( water_density[i] > water_density[peak] ) { peak = i; }
+    if( i > 0 && water_viscosity[i] >= water_viscosity[i-1] ) {
+      printf("FAILED: viscosity at %d C not below %d C\n", t, t - 1);
+      failed++;
+    }
+  }
+  printf("  density:   worst %.3f LSB at %d C, peak %.3f kg/m^3 at %d C\n", worst_rho,
+         worst_rho_t, water_density[peak] / 64.0, WATER_TABLE_TMIN + peak);
+  printf("  viscosity: worst %.3f LSB at %d C, %.3f to %.3f mPa s\n", worst_mu, worst_mu_t,
+         water_viscosity[0] / 65536.0, water_viscosity[WATER_TABLE_ROWS - 1] / 65536.0);
+  if( worst_rho > 0.5 || worst_mu > 0.5 ) {
+    printf("FAILED: an entry is not the rounded formula\n");
+    failed++;
+  }
+  if( WATER_TABLE_TMIN + peak != 4 ) {
+    printf("FAILED: density peaks at %d C\n", WATER_TABLE_TMIN + peak);
+    failed++;
+  }
+  printf(failed ? "Failed\n\n" : "Passed\n\n");
+  printf("tables: %d bytes of flash\n", (int) (sizeof(water_density) + sizeof(water_viscosity)));
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,175 @@
+@ Generated by host_test/gen_thumb_asm from the armcc __asm routines,
+@ do not edit.  GNU assembler syntax for the host simulator (test_thumb).
+
+  .syntax unified
+  .cpu cortex-m0plus
+  .thumb
+  .text
+
+@ sqrt in ../flowmeter/math_funcs.cpp
+@ Finds the truncated integer square root of value passed in via r0
+@ r0 : input value / return value
+@ r1 : low search boundary
+@ r2 : high search boundary
+@ r3 : new guess
+@ r4 : previous guess
+@ r5 : square of new_guess
+  .global sqrt
+  .type sqrt, %function
+  .thumb_func
+sqrt:
+  @ can we do this as skip next instruction?
+  CMP r0, #1  @ make sure we handle the edge case so sqrt(1)=1
+  BLS .Lsqrt_exit  @ just return the input if it is 0 or 1
+
+  MOVS r2, r0  @ use input as high search bound
+  MOVS r1, #1
+  LSLS r1, r1, #16  @ ...but no more than 2^16, so guess^2 fits in 32 bits
+  CMP r2, r1
+  BLS .Lsqrt_bounded
+  MOVS r2, r1
+.Lsqrt_bounded:
+  MOVS r1, #0  @ low search bound starts at 0
+
+  PUSH {r4, r5}  @ callee-saved, r3 is scratch
+  MOVS r3, #0  @ init guess
+  MOVS r4, r0  @ make last_guess != new_guess
+
+.Lsqrt_loop:
+
+  CMP r3, r4  @ if our guess was same as previous, we are done
+  BEQ .Lsqrt_endloop
+
+  @ update guess
+  MOVS r4, r3  @ last_guess = new_guess
+  ADDS r3, r1, r2  @ guess = low+high
+  LSRS r3, #1  @ guess/2
+
+  MOVS r5, r3
+  MULS r5, r5, r5  @ square of guess
+
+  CMP r5, r0  @ if guess^2 = input, we are done
+  BEQ .Lsqrt_endloop
+
+  @ can we use IT?
+  BHI .Lsqrt_toohigh
+.Lsqrt_toolow:
+  MOVS r1, r3  @ guess to low, make guess new low bound
+  B .Lsqrt_loop  @ can we do a "skip next" instead?
+.Lsqrt_toohigh:
+  MOVS r2, r3  @ guess to high, make guess new high bound
+  B .Lsqrt_loop
+
+.Lsqrt_endloop:
+  MOVS r0, r3  @ return guess
+  POP {r4, r5}
+
+.Lsqrt_exit:
+  BX lr
+  .size sqrt, . - sqrt
+
+@ my_sqrt in ../../m1/sqrt_approx/main.c
+@ Finds the truncated integer square root of value passed in via r0
+@ r0 : input value / return value
+@ r1 : low search boundary
+@ r2 : high search boundary
+@ r3 : new guess
+@ r4 : previous guess
+@ r5 : square of new_guess
+  .global my_sqrt
+  .type my_sqrt, %function
+  .thumb_func
+my_sqrt:
+  @ can we do this as skip next instruction?
+  CMP r0, #1  @ make sure we handle the edge case so sqrt(1)=1
+  BLS .Lmy_sqrt_exit  @ just return the input if it is 0 or 1
+
+  MOVS r2, r0  @ use input as high search bound
+  MOVS r1, #1
+  LSLS r1, r1, #16  @ ...but no more than 2^16, so guess^2 fits in 32 bits
+  CMP r2, r1
+  BLS .Lmy_sqrt_bounded
+  MOVS r2, r1
+.Lmy_sqrt_bounded:
+  MOVS r1, #0  @ low search bound starts at 0
+
+  PUSH {r4, r5}  @ callee-saved, r3 is scratch
+  MOVS r3, #0  @ init guess
+  MOVS r4, r0  @ make last_guess != new_guess
+
+.Lmy_sqrt_loop:
+
+  CMP r3, r4  @ if our guess was same as previous, we are done
+  BEQ .Lmy_sqrt_endloop
+
+  @ update guess
+  MOVS r4, r3  @ last_guess = new_guess
+  ADDS r3, r1, r2  @ guess = low+high
+  LSRS r3, #1  @ guess/2
+
+  MOVS r5, r3
+  MULS r5, r5, r5  @ square of guess
+
+  CMP r5, r0  @ if guess^2 = input, we are done
+  BEQ .Lmy_sqrt_endloop
+
+  @ can we use IT?
+  BHI .Lmy_sqrt_toohigh
+.Lmy_sqrt_toolow:
+  MOVS r1, r3  @ guess to low, make guess new low bound
+  B .Lmy_sqrt_loop  @ can we do a "skip next" instead?
+.Lmy_sqrt_toohigh:
+  MOVS r2, r3  @ guess to high, make guess new high bound
+  B .Lmy_sqrt_loop
+
+.Lmy_sqrt_endloop:
+  MOVS r0, r3  @ return guess
+  POP {r4, r5}
+
+.Lmy_sqrt_exit:
+  BX lr
+  .size my_sqrt, . - my_sqrt
+
+@ r0 in ../flowmeter/monitor.cpp
+@ Get register r0. No parameters to disturb its value.
+  .global get_r0
+  .type get_r0, %function
+  .thumb_func
+get_r0:
+  BX lr
+  .size get_r0, . - get_r0
+
+@ get_regs in ../flowmeter/monitor.cpp
+@ Dump registers r1-r15 to memory location specified by r0
+  .global get_regs
+  .type get_regs, %function
+  .thumb_func
+get_regs:
+  STM r0!, {r1-r7}  @ store the lo registers
+  MOV r1, r8
+  STR r1, [r0]  @ store r8 (r0 was advanced by STM)
+  MOV r1, r9
+  STR r1, [r0, #4]
+  MOV r1, r10
+  STR r1, [r0, #8]
+  MOV r1, r11
+  STR r1, [r0, #12]
+  MOV r1, r12
+  STR r1, [r0, #16]
+  MOV r1, r13
+  STR r1, [r0, #20]
+  MOV r1, r14
+  STR r1, [r0, #24]
+  MOV r1, r15
+  STR r1, [r0, #28]
+  BX lr
+  .size get_regs, . - get_regs
+
+@ get_sp in ../flowmeter/monitor.cpp
+  .global get_sp
+  .type get_sp, %function
+  .thumb_func
+get_sp:
+  MOV r0, sp
+  BX LR
+  .size get_sp, . - get_sp
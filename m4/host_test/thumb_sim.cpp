@@ -0,0 +1,715 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  thumb_sim.cpp
+
+  ARMv6-M (Thumb-1) interpreter.  Implements every 16-bit
+  ARMv6-M encoding plus BL and the barriers; MRS, MSR,
+  SVC and exceptions are not modelled.
+
+  Cycle counts are from the Cortex-M0+ TRM instruction
+  timing table, with the single-cycle multiplier the
+  KL25Z is built with and zero wait state memory:
+    data processing, MULS, ADR, extend, REV   1
+    ADD/MOV with pc as destination            2
+    LDR*, STR*                                2
+    LDM, STM, PUSH, POP (N registers)         1+N
+    POP including pc                          3+N
+    B<cond> taken / not taken                 2 / 1
+    B, BX, BLX                                2
+    BL                                        3
+    DMB, DSB, ISB                             3
+ --------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "thumb_sim.h"
+
+//******************************************************************************
+// Memory
+//******************************************************************************
+
+// host pointer for a simulated address range, NULL if unmapped
+static uint8_t *mem_ptr(thumb_cpu *cpu, uint32_t addr, uint32_t size) {
+  if( addr - THUMB_FLASH_BASE <= THUMB_FLASH_SIZE - size ) {
+    return cpu->flash + (addr - THUMB_FLASH_BASE);
+  }
+  if( addr - THUMB_RAM_BASE <= THUMB_RAM_SIZE - size ) {
+    return cpu->ram + (addr - THUMB_RAM_BASE);
+  }
+  return NULL;
+}
+
+static int mem_check(thumb_cpu *cpu, uint32_t addr, uint32_t size) {
+  if( addr & (size-1) ) {
+    cpu->fault = "unaligned access";
+    return -1;
+  }
+  if( !mem_ptr(cpu, addr, size) ) {
+    cpu->fault = "bus fault, unmapped address";
+    return -1;
+  }
+  return 0;
+}
+
+static uint32_t load(thumb_cpu *cpu, uint32_t addr, uint32_t size) {
+  uint8_t *p = mem_ptr(cpu, addr, size);
+  uint32_t value = 0;
+  for( int i=size-1; i>=0; i-- ) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+static void store(thumb_cpu *cpu, uint32_t addr, uint32_t size, uint32_t value) {
+  uint8_t *p = mem_ptr(cpu, addr, size);
+  for( uint32_t i=0; i<size; i++ ) {
+    p[i] = value >> (8*i);
+  }
+}
+
+uint32_t thumb_read32(thumb_cpu *cpu, uint32_t addr) {
+  return mem_ptr(cpu, addr, 4) ? load(cpu, addr, 4) : 0;
+}
+
+void thumb_write32(thumb_cpu *cpu, uint32_t addr, uint32_t value) {
+  if( mem_ptr(cpu, addr, 4) ) { store(cpu, addr, 4, value); }
+}
+
+//******************************************************************************
+// Flag helpers
+//******************************************************************************
+
+static void set_nz(thumb_cpu *cpu, uint32_t result) {
+  cpu->n = result >> 31;
+  cpu->z = (result == 0);
+}
+
+// x + y + carry, setting NZCV when flags is set (AddWithCarry in the ARM ARM)
+static uint32_t add_carry(thumb_cpu *cpu, uint32_t x, uint32_t y, int carry, int flags) {
+  uint64_t usum = (uint64_t) x + y + carry;
+  int64_t ssum = (int64_t) (int32_t) x + (int32_t) y + carry;
+  uint32_t result = (uint32_t) usum;
+  if( flags ) {
+    set_nz(cpu, result);
+    cpu->c = (usum >> 32) & 1;
+    cpu->v = ((int64_t) (int32_t) result != ssum);
+  }
+  return result;
+}
+
+enum shift_type { SH_LSL, SH_LSR, SH_ASR, SH_ROR };
+
+// shift by a register amount (0-255), updating C
+static uint32_t shift_c(thumb_cpu *cpu, int type, uint32_t x, uint32_t amount) {
+  if( amount == 0 ) { return x; }
+  switch( type ) {
+    case SH_LSL:
+      if( amount < 32 ) { cpu->c = (x >> (32 - amount)) & 1; return x << amount; }
+      cpu->c = (amount == 32) ? (x & 1) : 0;
+      return 0;
+    case SH_LSR:
+      if( amount < 32 ) { cpu->c = (x >> (amount - 1)) & 1; return x >> amount; }
+      cpu->c = (amount == 32) ? (x >> 31) : 0;
+      return 0;
+    case SH_ASR:
+      if( amount < 32 ) { cpu->c = (x >> (amount - 1)) & 1; return (uint32_t) ((int32_t) x >> amount); }
+      cpu->c = x >> 31;
+      return (x >> 31) ? 0xffffffff : 0;
+    default: // SH_ROR
+      amount &= 31;
+      if( amount ) { x = (x >> amount) | (x << (32 - amount)); }
+      cpu->c = x >> 31;
+      return x;
+  }
+}
+
+static int condition(thumb_cpu *cpu, int cond) {
+  switch( cond ) {
+    case 0x0: return cpu->z;                              // EQ
+    case 0x1: return !cpu->z;                             // NE
+    case 0x2: return cpu->c;                              // CS
+    case 0x3: return !cpu->c;                             // CC
+    case 0x4: return cpu->n;                              // MI
+    case 0x5: return !cpu->n;                             // PL
+    case 0x6: return cpu->v;                              // VS
+    case 0x7: return !cpu->v;                             // VC
+    case 0x8: return cpu->c && !cpu->z;                   // HI
+    case 0x9: return !cpu->c || cpu->z;                   // LS
+    case 0xa: return cpu->n == cpu->v;                    // GE
+    case 0xb: return cpu->n != cpu->v;                    // LT
+    case 0xc: return !cpu->z && (cpu->n == cpu->v);       // GT
+    case 0xd: return cpu->z || (cpu->n != cpu->v);        // LE
+    default:  return 1;                                   // AL
+  }
+}
+
+static int popcount(uint32_t list) {
+  int count = 0;
+  for( ; list; list &= list-1 ) { count++; }
+  return count;
+}
+
+//******************************************************************************
+// Execution
+//******************************************************************************
+
+// branch without interworking (B, BL, ADD/MOV pc)
+static void branch(thumb_cpu *cpu, uint32_t target, uint32_t *next_pc) {
+  (void) cpu;
+  *next_pc = target & ~1U;
+}
+
+// interworking branch (BX, BLX, POP pc): bit 0 must be set
+static int branch_interwork(thumb_cpu *cpu, uint32_t target, uint32_t *next_pc) {
+  if( !(target & 1) ) {
+    cpu->fault = "interworking branch to ARM state";
+    return -1;
+  }
+  *next_pc = target & ~1U;
+  return 0;
+}
+
+int thumb_step(thumb_cpu *cpu) {
+  uint32_t *r = cpu->r;
+  uint32_t addr = r[15];
+  uint32_t pc = addr + 4;  // value read from r15 by this instruction
+  uint32_t next_pc = addr + 2;
+  uint32_t op, rd, rn, rm, imm, x, y, result, list;
+  int cycles = 1;
+
+  if( mem_check(cpu, addr, 2) ) { cpu->fault_pc = addr; return -1; }
+  op = load(cpu, addr, 2);
+
+  switch( op >> 11 ) {
+
+    // LSLS/LSRS/ASRS Rd, Rm, #imm5
+    case 0x00: case 0x01: case 0x02:
+      rd = op & 7;
+      rm = (op >> 3) & 7;
+      imm = (op >> 6) & 0x1f;
+      x = r[rm];
+      if( (op >> 11) == 0 ) {
+        result = imm ? shift_c(cpu, SH_LSL, x, imm) : x;  // imm 0 is MOVS
+      } else {
+        result = shift_c(cpu, (op >> 11) == 1 ? SH_LSR : SH_ASR, x, imm ? imm : 32);
+      }
+      r[rd] = result;
+      set_nz(cpu, result);
+      break;
+
+    // ADDS/SUBS Rd, Rn, Rm|#imm3
+    case 0x03:
+      rd = op & 7;
+      rn = (op >> 3) & 7;
+      y = (op & 0x400) ? (op >> 6) & 7 : r[(op >> 6) & 7];
+      if( op & 0x200 ) {
+        r[rd] = add_carry(cpu, r[rn], ~y, 1, 1);
+      } else {
+        r[rd] = add_carry(cpu, r[rn], y, 0, 1);
+      }
+      break;
+
+    // MOVS/CMP/ADDS/SUBS Rd, #imm8
+    case 0x04: case 0x05: case 0x06: case 0x07:
+      rd = (op >> 8) & 7;
+      imm = op & 0xff;
+      switch( (op >> 11) & 3 ) {
+        case 0: r[rd] = imm; set_nz(cpu, imm); break;
+        case 1: add_carry(cpu, r[rd], ~imm, 1, 1); break;
+        case 2: r[rd] = add_carry(cpu, r[rd], imm, 0, 1); break;
+        case 3: r[rd] = add_carry(cpu, r[rd], ~imm, 1, 1); break;
+      }
+      break;
+
+    case 0x08:
+      if( !(op & 0x400) ) {
+        // data processing, Rdn, Rm
+        rd = op & 7;
+        rm = (op >> 3) & 7;
+        x = r[rd];
+        y = r[rm];
+        switch( (op >> 6) & 0xf ) {
+          case 0x0: r[rd] = x & y; set_nz(cpu, r[rd]); break;                       // ANDS
+          case 0x1: r[rd] = x ^ y; set_nz(cpu, r[rd]); break;                       // EORS
+          case 0x2: r[rd] = shift_c(cpu, SH_LSL, x, y & 0xff); set_nz(cpu, r[rd]); break;
+          case 0x3: r[rd] = shift_c(cpu, SH_LSR, x, y & 0xff); set_nz(cpu, r[rd]); break;
+          case 0x4: r[rd] = shift_c(cpu, SH_ASR, x, y & 0xff); set_nz(cpu, r[rd]); break;
+          case 0x5: r[rd] = add_carry(cpu, x, y, cpu->c, 1); break;                 // ADCS
+          case 0x6: r[rd] = add_carry(cpu, x, ~y, cpu->c, 1); break;                // SBCS
+          case 0x7: r[rd] = shift_c(cpu, SH_ROR, x, y & 0xff); set_nz(cpu, r[rd]); break;
+          case 0x8: set_nz(cpu, x & y); break;                                      // TST
+          case 0x9: r[rd] = add_carry(cpu, ~y, 0, 1, 1); break;                     // RSBS #0
+          case 0xa: add_carry(cpu, x, ~y, 1, 1); break;                             // CMP
+          case 0xb: add_carry(cpu, x, y, 0, 1); break;                              // CMN
+          case 0xc: r[rd] = x | y; set_nz(cpu, r[rd]); break;                       // ORRS
+          case 0xd: r[rd] = x * y; set_nz(cpu, r[rd]); break;                       // MULS
+          case 0xe: r[rd] = x & ~y; set_nz(cpu, r[rd]); break;                      // BICS
+          case 0xf: r[rd] = ~y; set_nz(cpu, r[rd]); break;                          // MVNS
+        }
+      } else {
+        // special data processing and branch exchange, high registers
+        rd = (op & 7) | ((op >> 4) & 8);
+        rm = (op >> 3) & 0xf;
+        y = (rm == 15) ? pc : r[rm];
+        switch( (op >> 8) & 3 ) {
+          case 0: // ADD Rdn, Rm
+            x = (rd == 15) ? pc : r[rd];
+            result = x + y;
+            if( rd == 15 ) {
+              cycles = 2;
+              branch(cpu, result, &next_pc);
+            } else {
+              r[rd] = result;
+            }
+            break;
+          case 1: // CMP Rn, Rm
+            x = (rd == 15) ? pc : r[rd];
+            add_carry(cpu, x, ~y, 1, 1);
+            break;
+          case 2: // MOV Rd, Rm
+            if( rd == 15 ) {
+              cycles = 2;
+              branch(cpu, y, &next_pc);
+            } else {
+              r[rd] = (rd == 13) ? (y & ~3U) : y;
+            }
+            break;
+          case 3: // BX/BLX Rm
+            cycles = 2;
+            if( op & 0x80 ) {
+              r[14] = (addr + 2) | 1;
+            }
+            if( branch_interwork(cpu, y, &next_pc) ) { cpu->fault_pc = addr; return -1; }
+            break;
+        }
+      }
+      break;
+
+    // LDR Rt, [pc, #imm8]
+    case 0x09:
+      rd = (op >> 8) & 7;
+      x = (pc & ~3U) + ((op & 0xff) << 2);
+      if( mem_check(cpu, x, 4) ) { cpu->fault_pc = addr; return -1; }
+      r[rd] = load(cpu, x, 4);
+      cycles = 2;
+      break;
+
+    // load/store, register offset
+    case 0x0a: case 0x0b: {
+      static const uint32_t sizes[8] = { 4, 2, 1, 1, 4, 2, 1, 2 };
+      int opb = (op >> 9) & 7;
+      rd = op & 7;
+      x = r[(op >> 3) & 7] + r[(op >> 6) & 7];
+      if( mem_check(cpu, x, sizes[opb]) ) { cpu->fault_pc = addr; return -1; }
+      switch( opb ) {
+        case 0: store(cpu, x, 4, r[rd]); break;                        // STR
+        case 1: store(cpu, x, 2, r[rd]); break;                        // STRH
+        case 2: store(cpu, x, 1, r[rd]); break;                        // STRB
+        case 3: r[rd] = (uint32_t) (int8_t) load(cpu, x, 1); break;    // LDRSB
+        case 4: r[rd] = load(cpu, x, 4); break;                        // LDR
+        case 5: r[rd] = load(cpu, x, 2); break;                        // LDRH
+        case 6: r[rd] = load(cpu, x, 1); break;                        // LDRB
+        case 7: r[rd] = (uint32_t) (int16_t) load(cpu, x, 2); break;   // LDRSH
+      }
+      cycles = 2;
+      break;
+    }
+
+    // STR/LDR/STRB/LDRB/STRH/LDRH Rt, [Rn, #imm5]
+    case 0x0c: case 0x0d: case 0x0e: case 0x0f: case 0x10: case 0x11: {
+      uint32_t size = ((op >> 11) <= 0x0d) ? 4 : ((op >> 11) <= 0x0f) ? 1 : 2;
+      rd = op & 7;
+      x = r[(op >> 3) & 7] + ((op >> 6) & 0x1f) * size;
+      if( mem_check(cpu, x, size) ) { cpu->fault_pc = addr; return -1; }
+      if( op & 0x800 ) {
+        r[rd] = load(cpu, x, size);
+      } else {
+        store(cpu, x, size, r[rd]);
+      }
+      cycles = 2;
+      break;
+    }
+
+    // STR/LDR Rt, [sp, #imm8]
+    case 0x12: case 0x13:
+      rd = (op >> 8) & 7;
+      x = r[13] + ((op & 0xff) << 2);
+      if( mem_check(cpu, x, 4) ) { cpu->fault_pc = addr; return -1; }
+      if( op & 0x800 ) {
+        r[rd] = load(cpu, x, 4);
+      } else {
+        store(cpu, x, 4, r[rd]);
+      }
+      cycles = 2;
+      break;
+
+    // ADR Rd, label / ADD Rd, sp, #imm8
+    case 0x14: case 0x15:
+      rd = (op >> 8) & 7;
+      x = (op & 0x800) ? r[13] : (pc & ~3U);
+      r[rd] = x + ((op & 0xff) << 2);
+      break;
+
+    // miscellaneous
+    case 0x16: case 0x17:
+      if( (op & 0xff00) == 0xb000 ) {
+        // ADD/SUB sp, sp, #imm7
+        imm = (op & 0x7f) << 2;
+        r[13] = (op & 0x80) ? r[13] - imm : r[13] + imm;
+      } else if( (op & 0xff00) == 0xb200 ) {
+        rd = op & 7;
+        x = r[(op >> 3) & 7];
+        switch( (op >> 6) & 3 ) {
+          case 0: r[rd] = (uint32_t) (int16_t) x; break;  // SXTH
+          case 1: r[rd] = (uint32_t) (int8_t) x; break;   // SXTB
+          case 2: r[rd] = x & 0xffff; break;              // UXTH
+          case 3: r[rd] = x & 0xff; break;                // UXTB
+        }
+      } else if( (op & 0xfe00) == 0xb400 ) {
+        // PUSH {list, lr}
+        list = (op & 0xff) | ((op & 0x100) << 6);
+        x = r[13] - 4 * popcount(list);
+        if( mem_check(cpu, x, 4) || mem_check(cpu, r[13] - 4, 4) ) { cpu->fault_pc = addr; return -1; }
+        r[13] = x;
+        for( int i=0; i<15; i++ ) {
+          if( list & (1 << i) ) { store(cpu, x, 4, r[i]); x += 4; }
+        }
+        cycles = 1 + popcount(list);
+      } else if( (op & 0xffef) == 0xb662 ) {
+        // CPSIE/CPSID i, interrupts are not modelled
+      } else if( (op & 0xff00) == 0xba00 && ((op >> 6) & 3) != 2 ) {
+        rd = op & 7;
+        x = r[(op >> 3) & 7];
+        switch( (op >> 6) & 3 ) {
+          case 0: r[rd] = __builtin_bswap32(x); break;                                    // REV
+          case 1: r[rd] = ((x & 0x00ff00ff) << 8) | ((x >> 8) & 0x00ff00ff); break;       // REV16
+          case 3: r[rd] = (uint32_t) (int16_t) (((x & 0xff) << 8) | ((x >> 8) & 0xff)); break; // REVSH
+        }
+      } else if( (op & 0xfe00) == 0xbc00 ) {
+        // POP {list, pc}
+        list = (op & 0xff) | ((op & 0x100) << 7);
+        x = r[13];
+        if( mem_check(cpu, x, 4) || mem_check(cpu, x + 4 * popcount(list) - 4, 4) ) {
+          cpu->fault_pc = addr;
+          return -1;
+        }
+        r[13] = x + 4 * popcount(list);
+        for( int i=0; i<8; i++ ) {
+          if( list & (1 << i) ) { r[i] = load(cpu, x, 4); x += 4; }
+        }
+        cycles = 1 + popcount(list);
+        if( list & 0x8000 ) {
+          cycles += 2;
+          if( branch_interwork(cpu, load(cpu, x, 4), &next_pc) ) { cpu->fault_pc = addr; return -1; }
+        }
+      } else if( (op & 0xff00) == 0xbe00 ) {
+        cpu->fault = "BKPT";
+        cpu->fault_pc = addr;
+        return -1;
+      } else if( (op & 0xff0f) == 0xbf00 && (op & 0xf0) <= 0x40 ) {
+        // NOP, YIELD, WFE, WFI, SEV
+      } else {
+        cpu->fault = "undefined instruction";
+        cpu->fault_pc = addr;
+        return -1;
+      }
+      break;
+
+    // STM/LDM Rn!, {list}
+    case 0x18: case 0x19:
+      rn = (op >> 8) & 7;
+      list = op & 0xff;
+      x = r[rn];
+      if( !list || mem_check(cpu, x, 4) || mem_check(cpu, x + 4 * popcount(list) - 4, 4) ) {
+        if( !list ) { cpu->fault = "unpredictable, empty register list"; }
+        cpu->fault_pc = addr;
+        return -1;
+      }
+      for( int i=0; i<8; i++ ) {
+        if( list & (1 << i) ) {
+          if( op & 0x800 ) {
+            r[i] = load(cpu, x, 4);
+          } else {
+            store(cpu, x, 4, r[i]);
+          }
+          x += 4;
+        }
+      }
+      // LDM only writes back when the base is not loaded
+      if( !(op & 0x800) || !(list & (1 << rn)) ) { r[rn] = x; }
+      cycles = 1 + popcount(list);
+      break;
+
+    // B<cond>, UDF, SVC
+    case 0x1a: case 0x1b:
+      if( ((op >> 8) & 0xf) >= 0xe ) {
+        cpu->fault = ((op >> 8) & 0xf) == 0xe ? "UDF" : "SVC not supported";
+        cpu->fault_pc = addr;
+        return -1;
+      }
+      if( condition(cpu, (op >> 8) & 0xf) ) {
+        cycles = 2;
+        branch(cpu, pc + ((int32_t) (int8_t) (op & 0xff) << 1), &next_pc);
+      }
+      break;
+
+    // B label
+    case 0x1c:
+      cycles = 2;
+      branch(cpu, pc + ((int32_t) ((op & 0x7ff) << 21) >> 20), &next_pc);
+      break;
+
+    // 32-bit: BL, DMB/DSB/ISB
+    case 0x1e: {
+      uint32_t op2;
+      if( mem_check(cpu, addr + 2, 2) ) { cpu->fault_pc = addr; return -1; }
+      op2 = load(cpu, addr + 2, 2);
+      if( (op2 & 0xd000) == 0xd000 ) {
+        uint32_t s = (op >> 10) & 1;
+        uint32_t i1 = !(((op2 >> 13) & 1) ^ s);
+        uint32_t i2 = !(((op2 >> 11) & 1) ^ s);
+        int32_t offset = (s << 24) | (i1 << 23) | (i2 << 22) | ((op & 0x3ff) << 12) | ((op2 & 0x7ff) << 1);
+        offset = (offset << 7) >> 7;
+        r[14] = pc | 1;
+        branch(cpu, pc + offset, &next_pc);
+        cycles = 3;
+      } else if( (op & 0xfff0) == 0xf3b0 && (op2 & 0xff00) == 0x8f00 ) {
+        next_pc = addr + 4;
+        cycles = 3;
+      } else {
+        cpu->fault = "32-bit instruction not supported";
+        cpu->fault_pc = addr;
+        return -1;
+      }
+      break;
+    }
+
+    default:
+      cpu->fault = "undefined instruction";
+      cpu->fault_pc = addr;
+      return -1;
+  }
+
+  r[15] = next_pc;
+  cpu->cycles += cycles;
+  cpu->instructions++;
+  return 0;
+}
+
+uint32_t thumb_call(thumb_cpu *cpu, uint32_t addr, int argc, const uint32_t *args,
+                    uint64_t max_cycles) {
+  for( int i=0; i<13; i++ ) {
+    cpu->r[i] = (i < argc) ? args[i] : 0x04040404U * i;
+  }
+  cpu->r[13] = THUMB_RAM_BASE + THUMB_RAM_SIZE;
+  cpu->r[14] = THUMB_RETURN | 1;
+  cpu->r[15] = addr & ~1U;
+  cpu->cycles = 0;
+  cpu->instructions = 0;
+  cpu->fault = NULL;
+
+  while( cpu->r[15] != THUMB_RETURN ) {
+    if( thumb_step(cpu) ) { break; }
+    if( cpu->cycles > max_cycles ) {
+      cpu->fault = "cycle limit exceeded";
+      cpu->fault_pc = cpu->r[15];
+      break;
+    }
+  }
+  return cpu->r[0];
+}
+
+//******************************************************************************
+// ELF loading
+//******************************************************************************
+
+#define EM_ARM 40
+#define ET_REL 1
+#define ET_EXEC 2
+#define PT_LOAD 1
+#define SHT_SYMTAB 2
+#define SHT_NOBITS 8
+#define SHT_REL 9
+#define SHF_WRITE 1
+#define SHF_ALLOC 2
+#define R_ARM_ABS32 2
+#define R_ARM_REL32 3
+#define R_ARM_THM_CALL 10
+
+struct elf32_ehdr {
+  uint8_t  e_ident[16];
+  uint16_t e_type, e_machine;
+  uint32_t e_version, e_entry, e_phoff, e_shoff, e_flags;
+  uint16_t e_ehsize, e_phentsize, e_phnum, e_shentsize, e_shnum, e_shstrndx;
+};
+
+struct elf32_phdr {
+  uint32_t p_type, p_offset, p_vaddr, p_paddr, p_filesz, p_memsz, p_flags, p_align;
+};
+
+struct elf32_shdr {
+  uint32_t sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size, sh_link, sh_info,
+           sh_addralign, sh_entsize;
+};
+
+struct elf32_sym {
+  uint32_t st_name, st_value, st_size;
+  uint8_t  st_info, st_other;
+  uint16_t st_shndx;
+};
+
+static int load_bytes(thumb_cpu *cpu, uint32_t addr, const uint8_t *data,
+                      uint32_t filesz, uint32_t memsz) {
+  uint8_t *p = mem_ptr(cpu, addr, memsz ? memsz : 1);
+  if( !p ) {
+    printf("ELF: segment 0x%08x+%u outside flash/RAM\n", addr, memsz);
+    return -1;
+  }
+  memset(p, 0, memsz);
+  memcpy(p, data, filesz);
+  return 0;
+}
+
+// BL offset field of a Thumb BL pair, and the inverse
+static int32_t bl_offset(uint32_t op, uint32_t op2) {
+  uint32_t s = (op >> 10) & 1;
+  uint32_t i1 = !(((op2 >> 13) & 1) ^ s);
+  uint32_t i2 = !(((op2 >> 11) & 1) ^ s);
+  int32_t offset = (s << 24) | (i1 << 23) | (i2 << 22) | ((op & 0x3ff) << 12) | ((op2 & 0x7ff) << 1);
+  return (offset << 7) >> 7;
+}
+
+static void bl_encode(uint32_t *op, uint32_t *op2, int32_t offset) {
+  uint32_t s = (offset >> 24) & 1;
+  uint32_t j1 = !((offset >> 23) & 1) ^ s;
+  uint32_t j2 = !((offset >> 22) & 1) ^ s;
+  *op = 0xf000 | (s << 10) | ((offset >> 12) & 0x3ff);
+  *op2 = 0xd000 | (j1 << 13) | (j2 << 11) | ((offset >> 1) & 0x7ff);
+}
+
+int thumb_load_elf(thumb_cpu *cpu, const char *path) {
+  FILE *f = fopen(path, "rb");
+  uint8_t *elf;
+  long size;
+  int status = -1;
+
+  if( !f ) {
+    printf("ELF: cannot open %s\n", path);
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  elf = (uint8_t *) malloc(size);
+  if( fread(elf, 1, size, f) != (size_t) size ) { size = 0; }
+  fclose(f);
+
+  elf32_ehdr *eh = (elf32_ehdr *) elf;
+  if( size < (long) sizeof(*eh) || memcmp(eh->e_ident, "\x7f" "ELF\x01\x01", 6)
+      || eh->e_machine != EM_ARM ) {
+    printf("ELF: %s is not a little-endian ARM ELF32 file\n", path);
+    free(elf);
+    return -1;
+  }
+
+  elf32_shdr *sh = (elf32_shdr *) (elf + eh->e_shoff);
+  uint32_t *base = (uint32_t *) calloc(eh->e_shnum, sizeof(uint32_t));
+  memset(cpu->flash, 0xff, sizeof(cpu->flash));  // erased flash
+  memset(cpu->ram, 0, sizeof(cpu->ram));
+  cpu->symbol_count = 0;
+
+  if( eh->e_type == ET_EXEC ) {
+    elf32_phdr *ph = (elf32_phdr *) (elf + eh->e_phoff);
+    for( int i=0; i<eh->e_phnum; i++ ) {
+      if( ph[i].p_type == PT_LOAD && ph[i].p_memsz &&
+          load_bytes(cpu, ph[i].p_paddr, elf + ph[i].p_offset, ph[i].p_filesz, ph[i].p_memsz) ) {
+        goto done;
+      }
+    }
+  } else if( eh->e_type == ET_REL ) {
+    // place read-only sections in flash past the vector table and flash
+    // configuration field, writable ones in RAM
+    uint32_t flash_next = THUMB_FLASH_BASE + 0x800, ram_next = THUMB_RAM_BASE;
+    for( int i=0; i<eh->e_shnum; i++ ) {
+      if( !(sh[i].sh_flags & SHF_ALLOC) ) { continue; }
+      uint32_t align = sh[i].sh_addralign ? sh[i].sh_addralign : 1;
+      uint32_t *next = (sh[i].sh_flags & SHF_WRITE) ? &ram_next : &flash_next;
+      *next = (*next + align - 1) & ~(align - 1);
+      base[i] = *next;
+      *next += sh[i].sh_size;
+      if( load_bytes(cpu, base[i], elf + sh[i].sh_offset,
+                     sh[i].sh_type == SHT_NOBITS ? 0 : sh[i].sh_size, sh[i].sh_size) ) {
+        goto done;
+      }
+    }
+  } else {
+    printf("ELF: %s is neither an executable nor an object file\n", path);
+    goto done;
+  }
+
+  for( int i=0; i<eh->e_shnum; i++ ) {
+    if( sh[i].sh_type != SHT_SYMTAB ) { continue; }
+    elf32_sym *syms = (elf32_sym *) (elf + sh[i].sh_offset);
+    const char *strtab = (const char *) (elf + sh[sh[i].sh_link].sh_offset);
+    int count = sh[i].sh_size / sizeof(elf32_sym);
+
+    // symbols of functions and objects
+    for( int j=0; j<count; j++ ) {
+      int type = syms[j].st_info & 0xf;
+      if( (type != 1 && type != 2) || !syms[j].st_shndx || syms[j].st_shndx >= eh->e_shnum ) { continue; }
+      if( cpu->symbol_count == THUMB_MAX_SYMBOLS ) { break; }
+      thumb_symbol *ts = &cpu->symbols[cpu->symbol_count++];
+      snprintf(ts->name, sizeof(ts->name), "%s", strtab + syms[j].st_name);
+      ts->addr = (base[syms[j].st_shndx] + syms[j].st_value) & ~1U;
+    }
+
+    // relocations, object files only
+    for( int k=0; eh->e_type == ET_REL && k<eh->e_shnum; k++ ) {
+      if( sh[k].sh_type != SHT_REL || sh[k].sh_link != (uint32_t) i ||
+          !(sh[sh[k].sh_info].sh_flags & SHF_ALLOC) ) {
+        continue;
+      }
+      uint32_t *rel = (uint32_t *) (elf + sh[k].sh_offset);
+      for( uint32_t n=0; n < sh[k].sh_size / 8; n++ ) {
+        uint32_t p = base[sh[k].sh_info] + rel[2*n];
+        uint32_t type = rel[2*n+1] & 0xff;
+        elf32_sym *sym = &syms[rel[2*n+1] >> 8];
+        if( sym->st_shndx == 0 || sym->st_shndx >= eh->e_shnum ) {
+          printf("ELF: undefined symbol %s\n", strtab + sym->st_name);
+          goto done;
+        }
+        uint32_t s = base[sym->st_shndx] + sym->st_value;
+        if( type == R_ARM_ABS32 ) {
+          store(cpu, p, 4, s + load(cpu, p, 4));
+        } else if( type == R_ARM_REL32 ) {
+          store(cpu, p, 4, s + load(cpu, p, 4) - p);
+        } else if( type == R_ARM_THM_CALL ) {
+          uint32_t op = load(cpu, p, 2), op2 = load(cpu, p+2, 2);
+          bl_encode(&op, &op2, (int32_t) ((s & ~1U) + bl_offset(op, op2) - p));
+          store(cpu, p, 2, op);
+          store(cpu, p+2, 2, op2);
+        } else {
+          printf("ELF: unsupported relocation type %u\n", type);
+          goto done;
+        }
+      }
+    }
+  }
+  status = 0;
+
+done:
+  free(base);
+  free(elf);
+  return status;
+}
+
+uint32_t thumb_symbol_addr(thumb_cpu *cpu, const char *name) {
+  for( int i=0; i<cpu->symbol_count; i++ ) {
+    if( !strcmp(cpu->symbols[i].name, name) ) {
+      return cpu->symbols[i].addr;
+    }
+  }
+  return 0;
+}
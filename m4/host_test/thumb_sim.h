@@ -0,0 +1,69 @@
+/*--------------------------------------------------------
+ECEN5003 - Project 1, Module 4
+  thumb_sim.h
+
+  Host-side ARMv6-M (Thumb-1) interpreter with Cortex-M0+
+  cycle counts, for running the hand-written assembly
+  routines without a board.
+ --------------------------------------------------------*/
+
+#ifndef _THUMB_SIM_H
+#define _THUMB_SIM_H
+
+#include <stdint.h>
+
+// KL25Z memory map: 128 KB flash at 0, 16 KB SRAM straddling 0x20000000
+#define THUMB_FLASH_BASE 0x00000000U
+#define THUMB_FLASH_SIZE 0x00020000U
+#define THUMB_RAM_BASE   0x1FFFF000U
+#define THUMB_RAM_SIZE   0x00004000U
+
+// LR on entry to a call; returning here (bx lr, pop {pc}) ends the call
+#define THUMB_RETURN     0xFFFFFFFEU
+
+#define THUMB_MAX_SYMBOLS 256
+
+struct thumb_symbol {
+  char name[64];
+  uint32_t addr;  // Thumb bit cleared
+};
+
+struct thumb_cpu {
+  uint32_t r[16];       // r[15] is the address of the current instruction
+  int n, z, c, v;       // APSR flags
+  uint64_t cycles;      // M0+ cycles since the start of the call
+  uint64_t instructions;
+  const char *fault;    // reason execution stopped early, NULL if none
+  uint32_t fault_pc;
+
+  uint8_t flash[THUMB_FLASH_SIZE];
+  uint8_t ram[THUMB_RAM_SIZE];
+
+  thumb_symbol symbols[THUMB_MAX_SYMBOLS];
+  int symbol_count;
+};
+
+// Load an ARM ELF32 executable or relocatable object (as produced by
+// arm-none-eabi-as).  Returns 0 on success, prints the problem otherwise.
+int thumb_load_elf(thumb_cpu *cpu, const char *path);
+
+// Address of a loaded function or object, 0 if not found.
+uint32_t thumb_symbol_addr(thumb_cpu *cpu, const char *name);
+
+// Call the routine at addr with up to four arguments in r0-r3 (AAPCS).
+// r4-r12 are set to a known pattern (0x04040404 * n) so callee-saved
+// registers can be checked afterwards, sp starts at the top of RAM.
+// Runs until the routine returns or max_cycles pass.  Returns r0, check
+// cpu->fault for errors.  cpu->cycles counts every instruction executed in
+// the routine including its return, not the caller's BL.
+uint32_t thumb_call(thumb_cpu *cpu, uint32_t addr, int argc, const uint32_t *args,
+                    uint64_t max_cycles);
+
+// Execute a single instruction.  Returns 0, or -1 on a fault.
+int thumb_step(thumb_cpu *cpu);
+
+// Memory access for the test harness (no alignment checks or cycles).
+uint32_t thumb_read32(thumb_cpu *cpu, uint32_t addr);
+void thumb_write32(thumb_cpu *cpu, uint32_t addr, uint32_t value);
+
+#endif